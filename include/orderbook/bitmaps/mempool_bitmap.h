@@ -1,42 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
 
 namespace orderbook::bitmaps {
     class mempool_bitmap
     {
-        std::int64_t static constexpr BITMAP_SIZE = 10;
+        // Each summary level holds one bit per word of the level below, set while that word has a free slot.
+        // Six levels of 64-bit words address 64^6 slots, far beyond any pool we size at startup.
+        std::int64_t static constexpr MAX_LEVELS = 6;
+        std::int64_t static constexpr DEFAULT_SLOTS = 640;
 
         private:
-            std::int64_t bm[BITMAP_SIZE];
+            std::uint64_t* bm;
+            std::uint64_t* levels[MAX_LEVELS]; // levels[0] is one bit per slot, the last level is a single word.
+            std::int64_t n_levels;
+            std::int64_t n_slots;
+
+            static std::int64_t words_for(std::int64_t bits)
+            {
+                return (bits + 63) >> 6;
+            }
+
+            void set_bit(std::int64_t index)
+            {
+                // Propagate upwards only while a word transitions from empty to non-empty.
+                for (std::int64_t l = 0; l < n_levels; l++)
+                {
+                    std::int64_t w = index >> 6;
+                    bool was_empty = levels[l][w] == 0;
+                    levels[l][w] |= 1ULL << (index & 63);
+                    if (!was_empty) return;
+                    index = w;
+                }
+            }
+
+            void clear_bit(std::int64_t index)
+            {
+                // Propagate upwards only while a word transitions from non-empty to empty.
+                for (std::int64_t l = 0; l < n_levels; l++)
+                {
+                    std::int64_t w = index >> 6;
+                    levels[l][w] &= ~(1ULL << (index & 63));
+                    if (levels[l][w] != 0) return;
+                    index = w;
+                }
+            }
 
         public:
-            mempool_bitmap()
+            mempool_bitmap(std::int64_t n = DEFAULT_SLOTS, bool all_free = true)
             {
-                for (int i = 0; i < BITMAP_SIZE; i++)
+                n_slots = n;
+                n_levels = 0;
+                std::int64_t total_words = 0;
+                std::int64_t bits = n_slots;
+                do
+                {
+                    total_words += words_for(bits);
+                    bits = words_for(bits);
+                    n_levels++;
+                } while (bits > 1 && n_levels < MAX_LEVELS);
+
+                bm = static_cast<std::uint64_t*>(std::calloc(total_words + 1, sizeof(std::uint64_t))); // +1 keeps an empty pool readable.
+                bits = n_slots;
+                std::uint64_t* level = bm;
+                for (std::int64_t l = 0; l < n_levels; l++)
+                {
+                    levels[l] = level;
+                    level += words_for(bits);
+                    bits = words_for(bits);
+                }
+                if (all_free)
                 {
-                    bm[i] = ~0ULL;
+                    release_range(0, n_slots);
                 }
             }
 
-            size_t aquire()
+            ~mempool_bitmap()
             {
-                for( std::int64_t w = 0; w < BITMAP_SIZE; w++)
+                std::free(bm);
+            }
+
+            std::int64_t aquire()
+            {
+                // Descend from the top summary word, taking the lowest free slot. O(levels) regardless of occupancy.
+                std::int64_t top = n_levels - 1;
+                if (levels[top][0] == 0)
+                {
+                    return -1;
+                }
+                std::int64_t index = 0;
+                for (std::int64_t l = top; l >= 0; l--)
                 {
-                    std::int64_t x = bm[w];
-                    if (x != 0)
-                    {
-                        std::int64_t b = __builtin_ctzll(x); 
-                        bm[w] = x & (x - 1);
-                        size_t complete_index = (w << 6) + b;
-                        return complete_index;
-                    };
+                    index = (index << 6) + __builtin_ctzll(levels[l][index]);
                 }
-                return -1;
+                clear_bit(index);
+                return index;
             }
 
             void release(std::int64_t index)
             {
-                size_t w = index >> 6;
-                size_t b = index & 63;
-                bm[w] |= (1ULL << b);
+                set_bit(index);
+            }
+
+            void release_range(std::int64_t begin, std::int64_t end)
+            {
+                for (std::int64_t i = begin; i < end; i++)
+                {
+                    set_bit(i);
+                }
+            }
+
+            bool is_free(std::int64_t index)
+            {
+                return (levels[0][index >> 6] & (1ULL << (index & 63))) != 0;
+            }
+
+            std::int64_t get_capacity()
+            {
+                return n_slots;
             }
     };
 }
@@ -1,19 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
 
 namespace orderbook::bitmaps {
     class tick_level_bitmap
     {
-        std::int64_t static constexpr BITMAP_SIZE = 15625;
+        std::int64_t static constexpr BITMAP_SIZE = 15625; // words by default, one million tick levels.
 
         private:
-            std::int64_t bm[BITMAP_SIZE];
+            std::int64_t* bm;
+            std::int64_t n_words;
 
         public:
-            tick_level_bitmap()
+            tick_level_bitmap(std::int64_t n_tick_levels = BITMAP_SIZE * 64)
             {
-                for (int i = 0; i < BITMAP_SIZE; i++)
-                {
-                    bm[i] = 0;
-                }
+                n_words = (n_tick_levels + 63) >> 6;
+                bm = static_cast<std::int64_t*>(std::calloc(n_words, sizeof(std::int64_t)));
+            }
+
+            tick_level_bitmap(const tick_level_bitmap&) = delete;
+            tick_level_bitmap& operator=(const tick_level_bitmap&) = delete;
+
+            ~tick_level_bitmap()
+            {
+                std::free(bm);
             }
 
             void unset(std::int64_t index)
@@ -36,5 +47,39 @@ namespace orderbook::bitmaps {
                 size_t b = index & 63;
                 return (bm[w] & (1ULL << b)) != 0;
             }
+
+            std::int64_t find_next_set(std::int64_t index)
+            {
+                // First set tick level at or above index, or -1.
+                if (index < 0) index = 0;
+                std::int64_t w = index >> 6;
+                if (w >= n_words) return -1;
+                std::uint64_t x = static_cast<std::uint64_t>(bm[w]) & (~0ULL << (index & 63));
+                while (x == 0)
+                {
+                    if (++w == n_words) return -1;
+                    x = static_cast<std::uint64_t>(bm[w]);
+                }
+                return (w << 6) + __builtin_ctzll(x);
+            }
+
+            std::int64_t find_prev_set(std::int64_t index)
+            {
+                // Last set tick level at or below index, or -1.
+                if (index < 0) return -1;
+                std::int64_t w = index >> 6;
+                if (w >= n_words)
+                {
+                    w = n_words - 1;
+                    index = (w << 6) + 63;
+                }
+                std::uint64_t x = static_cast<std::uint64_t>(bm[w]) & (~0ULL >> (63 - (index & 63)));
+                while (x == 0)
+                {
+                    if (--w < 0) return -1;
+                    x = static_cast<std::uint64_t>(bm[w]);
+                }
+                return (w << 6) + 63 - __builtin_clzll(x);
+            }
     };
 }
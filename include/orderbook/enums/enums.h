@@ -1,9 +1,19 @@
-
+#pragma once
 enum order_type {
     ORDER_MARKET = 1,
     ORDER_STOP_LIMIT = 2,
     ORDER_LIMIT = 3,
-    ORDER_FILL_OR_KILL = 4
+    ORDER_FILL_OR_KILL = 4,
+    ORDER_IMMEDIATE_OR_CANCEL = 5,
+    ORDER_GOOD_TILL_DATE = 6,
+    ORDER_ICEBERG = 7
+};
+
+enum command_action {
+    COMMAND_ADD = 1,
+    COMMAND_CANCEL = 2,
+    COMMAND_MODIFY = 3,
+    COMMAND_MATCH = 4
 };
 
 enum order_side {
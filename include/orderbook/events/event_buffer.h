@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+
+namespace orderbook::events {
+
+    struct fill_event
+    {
+        std::int64_t aggressor_id;
+        std::int64_t resting_id;
+        std::int64_t price; // the resting order's price level.
+        std::int64_t size;
+    };
+
+    struct level_event
+    {
+        // The visible volume now resting at a price level, zero once the level is empty.
+        std::int64_t order_side;
+        std::int64_t tick_level;
+        std::int64_t volume;
+    };
+
+    struct mass_cancel_event
+    {
+        // One event per side of a mass cancel, however many orders it removed.
+        std::int64_t order_side;
+        std::int64_t min_tick_level;
+        std::int64_t max_tick_level;
+        std::int64_t owner; // -1 unless cancelled by owner.
+        std::int64_t orders; // resting and stop orders.
+        std::int64_t volume; // visible volume, neither stops nor the hidden reserve of icebergs are counted.
+    };
+
+    template <typename T>
+    class event_buffer
+    {
+        // Events are appended on the matching thread and published to the handler in batches, on flush() or when
+        // the buffer fills up, so consumers pay one call per batch instead of one per event.
+        public:
+            using handler = void (*)(const T* events, std::int64_t n_events, void* context);
+
+        private:
+            T* events;
+            std::int64_t n_events;
+            std::int64_t capacity;
+            handler on_flush;
+            void* context;
+
+        public:
+            event_buffer(std::int64_t n, handler on_flush = nullptr, void* context = nullptr) :
+                n_events(0), capacity(n), on_flush(on_flush), context(context)
+            {
+                events = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+            }
+
+            ~event_buffer()
+            {
+                std::free(events);
+            }
+
+            void set_handler(handler new_handler, void* new_context)
+            {
+                flush();
+                on_flush = new_handler;
+                context = new_context;
+            }
+
+            void push(const T& event)
+            {
+                if (n_events == capacity)
+                {
+                    flush();
+                }
+                events[n_events++] = event;
+            }
+
+            void flush()
+            {
+                if (n_events > 0 && on_flush != nullptr)
+                {
+                    on_flush(events, n_events, context);
+                }
+                n_events = 0;
+            }
+
+            std::int64_t get_size()
+            {
+                return n_events;
+            }
+    };
+}
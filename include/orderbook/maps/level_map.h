@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include "orderbook/enums/enums.h"
+#include "orderbook/bitmaps/tick_level_bitmap.h"
+
+namespace orderbook::maps
+{
+    struct price_level
+    {
+        std::int64_t tick_level;
+        std::int64_t volume;
+        std::int64_t n_orders;
+    };
+
+    class level_map
+    {
+        // Aggregated volume and order count per tick level for one side, with no per-order state. The occupancy
+        // bitmap finds the next level when the best one empties; the best level itself is cached.
+        struct level
+        {
+            std::int64_t volume;
+            std::int64_t n_orders;
+        };
+
+        private:
+            level* levels;
+            orderbook::bitmaps::tick_level_bitmap* occupied;
+            std::int64_t n_tick_levels;
+            std::int64_t side;
+            std::int64_t best;
+            std::int64_t n_levels;
+
+            bool is_better(std::int64_t tick_level, std::int64_t than)
+            {
+                return (side == order_side::BID) ? tick_level > than : tick_level < than;
+            }
+
+            std::int64_t find_next_level(std::int64_t from)
+            {
+                // The nearest occupied level at or beyond from, moving away from the touch, or -1.
+                return (side == order_side::BID) ? occupied->find_prev_set(from) : occupied->find_next_set(from);
+            }
+
+        public:
+            level_map(std::int64_t n, std::int64_t side) : n_tick_levels(n), side(side)
+            {
+                levels = static_cast<level*>(std::calloc(n_tick_levels, sizeof(level)));
+                occupied = new orderbook::bitmaps::tick_level_bitmap{n_tick_levels};
+                best = -1;
+                n_levels = 0;
+            }
+
+            ~level_map()
+            {
+                std::free(levels);
+                delete occupied;
+            }
+
+            void set_level(std::int64_t tick_level, std::int64_t volume, std::int64_t n_orders)
+            {
+                // Replaces the level, as published by a market-by-price feed. A volume of zero deletes it.
+                level& l = levels[tick_level];
+                bool was_occupied = l.volume > 0;
+                l.volume = (volume > 0) ? volume : 0;
+                l.n_orders = (volume > 0) ? n_orders : 0;
+                if (volume > 0 && !was_occupied)
+                {
+                    occupied->set(tick_level);
+                    n_levels++;
+                    if (best == -1 || is_better(tick_level, best))
+                    {
+                        best = tick_level;
+                    }
+                }
+                else if (volume <= 0 && was_occupied)
+                {
+                    occupied->unset(tick_level);
+                    n_levels--;
+                    if (tick_level == best)
+                    {
+                        best = find_next_level(tick_level);
+                    }
+                }
+            }
+
+            void add_to_level(std::int64_t tick_level, std::int64_t volume, std::int64_t n_orders)
+            {
+                // Applies a change in volume and order count, for feeds that publish deltas.
+                set_level(tick_level, levels[tick_level].volume + volume, levels[tick_level].n_orders + n_orders);
+            }
+
+            std::int64_t get_depth(std::int64_t max_levels, orderbook::maps::price_level* out)
+            {
+                // Writes up to max_levels occupied levels from the best outwards and returns how many were written.
+                std::int64_t n = 0;
+                for (std::int64_t tick_level = best; tick_level != -1 && n < max_levels; n++)
+                {
+                    out[n] = {tick_level, levels[tick_level].volume, levels[tick_level].n_orders};
+                    tick_level = find_next_level(tick_level + ((side == order_side::BID) ? -1 : 1));
+                }
+                return n;
+            }
+
+            std::int64_t get_best()
+            {
+                return best;
+            }
+
+            bool is_empty()
+            {
+                return best == -1;
+            }
+
+            std::int64_t get_total_volume_at_tick_level(std::int64_t tick_level)
+            {
+                return levels[tick_level].volume;
+            }
+
+            std::int64_t get_order_count_at_tick_level(std::int64_t tick_level)
+            {
+                return levels[tick_level].n_orders;
+            }
+
+            std::int64_t get_n_levels()
+            {
+                return n_levels;
+            }
+    };
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include "orderbook/pools/pool_grower.h"
+
+namespace orderbook::maps
+{
+    struct order_location
+    {
+        std::int64_t order_side;
+        std::int64_t tick_level; // -1 until the order has rested.
+        std::int64_t sequence;   // position within the ring_buffer at tick_level.
+        std::int64_t owner;      // -1 unless the order was submitted with an owner, used by mass cancels.
+    };
+
+    class order_index : public orderbook::pools::growable_pool
+    {
+        // Order ids are handed out sequentially, so the index is a flat array addressed by id, split into chunks
+        // that are appended as ids advance. Entries are never cleared: a location is checked against the queue
+        // it points at, which tells us whether the order is still resting.
+        std::int64_t static constexpr CHUNK_SIZE = 1 << 14;
+        std::int64_t static constexpr MAX_CHUNKS = 1 << 14;
+
+        private:
+            order_location** chunks;
+            orderbook::pools::pool_grower* grower;
+            std::atomic<order_location*> spare; // next chunk, prepared by the grower thread.
+            std::int64_t n_chunks;
+            bool growth_requested;
+
+            static order_location* allocate_locations()
+            {
+                return orderbook::pools::allocate_chunk<order_location>(CHUNK_SIZE, order_location{0, -1, -1, -1});
+            }
+
+            void request_growth()
+            {
+                if (growth_requested || grower == nullptr || n_chunks == MAX_CHUNKS) return;
+                growth_requested = grower->request_chunk(this);
+            }
+
+            void grow()
+            {
+                order_location* chunk = spare.exchange(nullptr, std::memory_order_acquire);
+                if (chunk == nullptr)
+                {
+                    chunk = allocate_locations();
+                }
+                chunks[n_chunks++] = chunk;
+                growth_requested = false;
+            }
+
+            order_location* locate(std::int64_t id)
+            {
+                // The entry for id, growing the index to reach it. nullptr if id is out of range.
+                std::int64_t chunk = id / CHUNK_SIZE;
+                if (id < 0 || chunk >= MAX_CHUNKS)
+                {
+                    return nullptr;
+                }
+                while (chunk >= n_chunks)
+                {
+                    grow();
+                }
+                if (chunk == n_chunks - 1 && id % CHUNK_SIZE >= CHUNK_SIZE - CHUNK_SIZE / 4)
+                {
+                    request_growth();
+                }
+                return &chunks[chunk][id % CHUNK_SIZE];
+            }
+
+        public:
+            order_index(orderbook::pools::pool_grower* grower = nullptr) : grower(grower), spare(nullptr)
+            {
+                chunks = static_cast<order_location**>(std::calloc(MAX_CHUNKS, sizeof(order_location*)));
+                n_chunks = 0;
+                growth_requested = false;
+                grow();
+            }
+
+            ~order_index()
+            {
+                for (std::int64_t i = 0; i < n_chunks; i++)
+                {
+                    orderbook::pools::free_chunk<order_location>(chunks[i], CHUNK_SIZE);
+                }
+                order_location* chunk = spare.exchange(nullptr);
+                if (chunk != nullptr)
+                {
+                    orderbook::pools::free_chunk<order_location>(chunk, CHUNK_SIZE);
+                }
+                std::free(chunks);
+            }
+
+            void prepare_chunk() override
+            {
+                if (spare.load(std::memory_order_acquire) == nullptr)
+                {
+                    spare.store(allocate_locations(), std::memory_order_release);
+                }
+            }
+
+            void reclaim_chunk(void* chunk, std::int64_t n) override
+            {
+                orderbook::pools::free_chunk<order_location>(static_cast<order_location*>(chunk), n);
+            }
+
+            bool set(std::int64_t id, std::int64_t order_side, std::int64_t tick_level, std::int64_t sequence)
+            {
+                // The owner is kept, an order that moves or is replenished stays with its owner.
+                order_location* location = locate(id);
+                if (location == nullptr)
+                {
+                    return false;
+                }
+                location->order_side = order_side;
+                location->tick_level = tick_level;
+                location->sequence = sequence;
+                return true;
+            }
+
+            bool set_owner(std::int64_t id, std::int64_t owner)
+            {
+                order_location* location = locate(id);
+                if (location == nullptr)
+                {
+                    return false;
+                }
+                location->owner = owner;
+                return true;
+            }
+
+            const order_location* get(std::int64_t id)
+            {
+                // nullptr for ids that have never rested in the book.
+                std::int64_t chunk = id / CHUNK_SIZE;
+                if (id < 0 || chunk >= n_chunks || chunks[chunk][id % CHUNK_SIZE].tick_level < 0)
+                {
+                    return nullptr;
+                }
+                return &chunks[chunk][id % CHUNK_SIZE];
+            }
+
+            std::int64_t get_owner(std::int64_t id)
+            {
+                // Unlike get(), also answers for orders that have not rested, such as untriggered stops.
+                std::int64_t chunk = id / CHUNK_SIZE;
+                if (id < 0 || chunk >= n_chunks)
+                {
+                    return -1;
+                }
+                return chunks[chunk][id % CHUNK_SIZE].owner;
+            }
+
+            std::int64_t get_n_chunks()
+            {
+                return n_chunks;
+            }
+    };
+}
@@ -1,5 +1,11 @@
+#pragma once
+#include <algorithm>
 #include <iostream>
 #include "orderbook/queues/ring_buffer.h"
+#include "orderbook/bitmaps/tick_level_bitmap.h"
+#include "orderbook/telemetry/counter.h"
+#include "orderbook/trees/fenwick_tree.h"
+#include "orderbook/events/event_buffer.h"
 
 namespace orderbook::maps
 {
@@ -8,28 +14,210 @@ namespace orderbook::maps
         private:
             orderbook::queues::ring_buffer* mempool;
             std::int64_t mempool_size;
+            orderbook::telemetry::counter resting_orders;
+            orderbook::trees::fenwick_tree* level_volumes; // cumulative volume index across tick levels.
+            orderbook::bitmaps::tick_level_bitmap* iceberg_levels; // levels that may hold iceberg orders, cleared once a level drains.
+            orderbook::events::event_buffer<orderbook::events::level_event>* level_events; // nullptr unless level changes are published.
+            std::int64_t side; // side reported in level events.
+
+            void change_level_volume(std::int64_t tick_level, std::int64_t delta)
+            {
+                // Called once the queue at tick_level already holds its new volume. A level that did not change
+                // publishes nothing.
+                if (delta == 0)
+                {
+                    return;
+                }
+                level_volumes->add(tick_level, delta);
+                if (level_events != nullptr)
+                {
+                    level_events->push({side, tick_level, (mempool+tick_level)->get_total_volume()});
+                }
+            }
+
+            void clear_iceberg_level_if_empty(std::int64_t tick_level)
+            {
+                if ((mempool+tick_level)->is_empty())
+                {
+                    iceberg_levels->unset(tick_level);
+                }
+            }
 
         public:
 
-            order_map(std::int64_t ms)
+            order_map(std::int64_t ms, orderbook::pools::pool_grower* grower = nullptr)
             {
                 mempool_size = ms;
                 mempool = static_cast<orderbook::queues::ring_buffer*>(std::malloc(mempool_size * sizeof(orderbook::queues::ring_buffer)));
                 for(std::int64_t i = 0; i < mempool_size; i++)
                 {
-                    new (mempool+i) orderbook::queues::ring_buffer{10}; // Only 10 orders can be ingressed currently.
+                    new (mempool+i) orderbook::queues::ring_buffer{10, grower}; // Queues start with 10 orders and grow in chunks of 10.
                 };
+                level_volumes = new orderbook::trees::fenwick_tree{mempool_size};
+                iceberg_levels = new orderbook::bitmaps::tick_level_bitmap{};
+                level_events = nullptr;
+                side = order_side::BID;
             }
 
-            void add_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price)
+            void publish_level_changes(orderbook::events::event_buffer<orderbook::events::level_event>* events, std::int64_t order_side)
             {
+                // Pushes a level_event to events every time the volume at a level changes, nullptr stops publishing.
+                level_events = events;
+                side = order_side;
+            }
+
+            std::int64_t add_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price)
+            {
+                // Returns the sequence number of the order within the queue at tick_level.
                 std::cout << "inserting " << ((order_side == 1) ? "bid" : "ask") << " order in queue at tick_level: " << tick_level << "\n";
-                (mempool+tick_level)->enqueue(id, order_side, order_size, order_type, order_limit_price);
+                std::int64_t sequence = (mempool+tick_level)->enqueue(id, order_side, order_size, order_type, order_limit_price);
+                resting_orders.increment();
+                change_level_volume(tick_level, order_size);
+                return sequence;
+            }
+
+            template <typename F>
+            std::int64_t add_orders(std::int64_t tick_level, std::int64_t n_orders, F&& set_order)
+            {
+                // Bulk version of add_order for loading a level, set_order(k, order) writes the k-th order in place.
+                // Returns the sequence number of the first order, the rest follow consecutively.
+                orderbook::queues::ring_buffer* queue = mempool+tick_level;
+                std::int64_t volume_before = queue->get_total_volume();
+                std::int64_t sequence = queue->enqueue_bulk(n_orders, set_order);
+                resting_orders.add(n_orders);
+                change_level_volume(tick_level, queue->get_total_volume() - volume_before);
+                return sequence;
+            }
+
+            std::int64_t add_iceberg_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_display_size)
+            {
+                // Only the first slice is queued and counted as volume, the rest is kept as reserve on the order itself.
+                std::int64_t visible_size = std::min(order_size, order_display_size);
+                std::int64_t sequence = add_order(id, tick_level, order_side, visible_size, order_type::ORDER_ICEBERG, -1);
+                (mempool+tick_level)->at(sequence)->set_reserve(order_size - visible_size, order_display_size);
+                iceberg_levels->set(tick_level);
+                return sequence;
+            }
+
+            std::int64_t replenish_order(std::int64_t tick_level, std::int64_t sequence)
+            {
+                // Called once the visible slice of an iceberg order is used up. The next slice is queued at the back
+                // of the level, so it loses time priority. Returns its sequence number.
+                orderbook::order* order = (mempool+tick_level)->at(sequence);
+                std::int64_t id = order->get_order_id();
+                std::int64_t order_side = order->get_side();
+                std::int64_t reserve = order->get_reserve();
+                std::int64_t display_size = order->get_display_size();
+                remove_order(tick_level, sequence);
+                return add_iceberg_order(id, tick_level, order_side, reserve, display_size);
+            }
+
+            void remove_order(std::int64_t tick_level, std::int64_t sequence)
+            {
+                // Removes a live order from anywhere in its queue.
+                std::int64_t size = (mempool+tick_level)->at(sequence)->get_size();
+                resting_orders.decrement();
+                (mempool+tick_level)->cancel(sequence);
+                change_level_volume(tick_level, -size);
+                clear_iceberg_level_if_empty(tick_level);
+            }
+
+            void partial_fill_order(std::int64_t tick_level, std::int64_t sequence, std::int64_t size_of_match)
+            {
+                (mempool+tick_level)->reduce_size(sequence, size_of_match);
+                change_level_volume(tick_level, -size_of_match);
+            }
+
+            void reduce_order(std::int64_t tick_level, std::int64_t sequence, std::int64_t size)
+            {
+                // Shrinks a resting order in place, keeping its queue position. Hidden reserve is used up first.
+                orderbook::order* order = (mempool+tick_level)->at(sequence);
+                std::int64_t from_reserve = std::min(size, order->get_reserve());
+                order->reduce_reserve(from_reserve);
+                if (size > from_reserve)
+                {
+                    (mempool+tick_level)->reduce_size(sequence, size - from_reserve);
+                    change_level_volume(tick_level, from_reserve - size);
+                }
+            }
+
+            bool cancel_order(std::int64_t id, std::int64_t tick_level, std::int64_t sequence)
+            {
+                orderbook::order* order = (mempool+tick_level)->find(sequence, id);
+                if (order == nullptr)
+                {
+                    return false;
+                }
+                remove_order(tick_level, sequence);
+                return true;
+            }
+
+            orderbook::queues::batch_fill clear_level(std::int64_t tick_level)
+            {
+                // Cancels every order at tick_level by resetting its queue, instead of cancelling them one at a time.
+                // Returns the live orders and visible volume removed.
+                orderbook::queues::ring_buffer* queue = mempool+tick_level;
+                orderbook::queues::batch_fill cleared = {0, queue->get_total_volume()};
+                for (std::int64_t sequence = queue->get_tail(); sequence < queue->get_head(); sequence++)
+                {
+                    cleared.orders += queue->is_live(sequence) ? 1 : 0;
+                }
+                queue->clear();
+                resting_orders.add(-cleared.orders);
+                change_level_volume(tick_level, -cleared.volume);
+                iceberg_levels->unset(tick_level);
+                return cleared;
+            }
+
+            template <typename F>
+            orderbook::queues::batch_fill cancel_orders_if(std::int64_t tick_level, F&& should_cancel)
+            {
+                // Cancels the orders at tick_level for which should_cancel(order) is true.
+                orderbook::queues::ring_buffer* queue = mempool+tick_level;
+                orderbook::queues::batch_fill cancelled = {0, 0};
+                for (std::int64_t sequence = queue->get_tail(), head = queue->get_head(); sequence < head; sequence++)
+                {
+                    if (!queue->is_live(sequence) || !should_cancel(queue->at(sequence))) continue;
+                    cancelled.orders++;
+                    cancelled.volume += queue->at(sequence)->get_size();
+                    remove_order(tick_level, sequence);
+                }
+                return cancelled;
+            }
+
+            orderbook::queues::queue_position get_queue_position(std::int64_t id, std::int64_t tick_level, std::int64_t sequence)
+            {
+                // {-1, -1} if the order is no longer resting at this location.
+                orderbook::queues::ring_buffer* queue = mempool+tick_level;
+                orderbook::order* order = queue->find(sequence, id);
+                if (order == nullptr || order->is_cancelled())
+                {
+                    return {-1, -1};
+                }
+                return queue->get_queue_position(sequence);
             }
 
             orderbook::order* remove_priority_order(std::int64_t tick_level)
             {
-                return (mempool+tick_level)->dequeue();
+                orderbook::order* order = (mempool+tick_level)->dequeue();
+                if (order != nullptr)
+                {
+                    resting_orders.decrement();
+                    change_level_volume(tick_level, -order->get_size());
+                    clear_iceberg_level_if_empty(tick_level);
+                }
+                return order;
+            }
+
+            template <bool check_reserve = true, typename F>
+            std::int64_t fill_priority_orders(std::int64_t tick_level, std::int64_t volume, F&& on_fill)
+            {
+                // Batch version of remove_priority_order for sweeps. Returns the volume filled.
+                orderbook::queues::batch_fill filled = (mempool+tick_level)->fill_from_tail<check_reserve>(volume, on_fill);
+                resting_orders.add(-filled.orders);
+                change_level_volume(tick_level, -filled.volume);
+                clear_iceberg_level_if_empty(tick_level);
+                return filled.volume;
             }
 
             orderbook::order* get_priority_order(std::int64_t tick_level)
@@ -39,6 +227,13 @@ namespace orderbook::maps
 
             void partial_fill_priority(std::int64_t tick_level, std::int64_t size_of_match) {
                 (mempool+tick_level)->reduce_size_of_tail(size_of_match);
+                change_level_volume(tick_level, -size_of_match);
+            }
+
+            bool has_icebergs(std::int64_t tick_level)
+            {
+                // False means every order at tick_level is a plain order with nothing in reserve.
+                return iceberg_levels->is_set(tick_level);
             }
 
             bool is_empty(std::int64_t tick_level)
@@ -53,6 +248,8 @@ namespace orderbook::maps
                     (mempool+i)->~ring_buffer();
                 };
                 std::free(mempool);
+                delete level_volumes;
+                delete iceberg_levels;
             }
 
             std::int64_t get_total_volume_at_tick_level(std::int64_t tick_level)
@@ -60,6 +257,57 @@ namespace orderbook::maps
                 return (mempool+tick_level)->get_total_volume();
             }
 
+            orderbook::queues::ring_buffer* get_queue(std::int64_t tick_level)
+            {
+                return mempool+tick_level;
+            }
+
+            std::int64_t get_mempool_size()
+            {
+                return mempool_size;
+            }
+
+            std::int64_t get_volume_at_or_below(std::int64_t tick_level)
+            {
+                return level_volumes->prefix_sum(tick_level);
+            }
+
+            std::int64_t get_volume_at_or_above(std::int64_t tick_level)
+            {
+                return level_volumes->suffix_sum(tick_level);
+            }
+
+            std::int64_t get_resting_orders()
+            {
+                return resting_orders.get();
+            }
+
+            std::int64_t get_depth_high_water_mark(std::int64_t tick_level)
+            {
+                return (mempool+tick_level)->get_depth_high_water_mark();
+            }
+
+            std::int64_t get_queue_growths()
+            {
+                // Summed by the reader so the matching thread only ever touches the counters of its own level.
+                std::int64_t total = 0;
+                for (std::int64_t i = 0; i < mempool_size; i++)
+                {
+                    total += (mempool+i)->get_growths();
+                }
+                return total;
+            }
+
+            std::int64_t get_queue_growths_on_matching_thread()
+            {
+                std::int64_t total = 0;
+                for (std::int64_t i = 0; i < mempool_size; i++)
+                {
+                    total += (mempool+i)->get_growths_on_matching_thread();
+                }
+                return total;
+            }
+
             void print_order_map(std::int64_t side)
             {
                 for (std::int64_t k = 0; k < mempool_size; k++) {
@@ -67,8 +315,14 @@ namespace orderbook::maps
                     // print bids lowest to highest
                     std::int64_t i = (side == 1) ? k : (mempool_size - 1 - k);
                     std::int64_t tick_level_total_volume = (mempool + i)->get_total_volume();
-                    std::string output(tick_level_total_volume, '#');
-                    std::cout << i << " | " << output << "\n";
+                    std::cout << i << " | ";
+                    char block[64];
+                    std::fill(block, block + 64, '#');
+                    for (; tick_level_total_volume > 0; tick_level_total_volume -= 64)
+                    {
+                        std::cout.write(block, std::min<std::int64_t>(tick_level_total_volume, 64));
+                    }
+                    std::cout << "\n";
                 }
             }
     };
@@ -0,0 +1,132 @@
+#pragma once
+#include <iostream>
+#include "orderbook/maps/order_map.h"
+#include "orderbook/bitmaps/tick_level_bitmap.h"
+
+namespace orderbook::maps
+{
+    class stop_map
+    {
+        // Resting stop-limit orders for one side, queued FIFO by trigger price. Buy stops trigger when the last
+        // trade price rises to their trigger, sell stops when it falls to it, so the nearest trigger is the lowest
+        // buy stop or the highest sell stop. Caching it makes the check after every fill a single comparison.
+        private:
+            orderbook::maps::order_map* queues;
+            orderbook::bitmaps::tick_level_bitmap* triggers;
+            std::int64_t side;
+            std::int64_t nearest_trigger;
+
+            std::int64_t find_nearest_trigger(std::int64_t from)
+            {
+                return (side == order_side::BID) ? triggers->find_next_set(from) : triggers->find_prev_set(from);
+            }
+
+            template <typename F>
+            std::int64_t cancel_levels(std::int64_t min_trigger, std::int64_t max_trigger, F&& cancel_level)
+            {
+                // Visits only trigger levels that hold stops, then moves the nearest trigger if its level emptied.
+                std::int64_t n_cancelled = 0;
+                for (std::int64_t trigger_price = triggers->find_next_set(min_trigger); trigger_price != -1 && trigger_price <= max_trigger;
+                     trigger_price = triggers->find_next_set(trigger_price + 1))
+                {
+                    n_cancelled += cancel_level(trigger_price).orders;
+                    if (queues->is_empty(trigger_price))
+                    {
+                        triggers->unset(trigger_price);
+                    }
+                }
+                if (nearest_trigger != -1 && !triggers->is_set(nearest_trigger))
+                {
+                    nearest_trigger = find_nearest_trigger(nearest_trigger);
+                }
+                return n_cancelled;
+            }
+
+        public:
+            stop_map(std::int64_t ms, std::int64_t side, orderbook::pools::pool_grower* grower = nullptr) : side(side)
+            {
+                queues = new orderbook::maps::order_map{ms, grower};
+                triggers = new orderbook::bitmaps::tick_level_bitmap{ms};
+                nearest_trigger = -1;
+            }
+
+            ~stop_map()
+            {
+                delete queues;
+                delete triggers;
+            }
+
+            void add_order(std::int64_t id, std::int64_t trigger_price, std::int64_t order_size, std::int64_t order_limit_price)
+            {
+                queues->add_order(id, trigger_price, side, order_size, order_type::ORDER_STOP_LIMIT, order_limit_price);
+                triggers->set(trigger_price);
+                bool is_nearer = (side == order_side::BID) ? trigger_price < nearest_trigger : trigger_price > nearest_trigger;
+                if (nearest_trigger == -1 || is_nearer)
+                {
+                    nearest_trigger = trigger_price;
+                }
+            }
+
+            std::int64_t get_triggered_level(std::int64_t last_trade_price)
+            {
+                // Returns the trigger price of the next stop level hit by last_trade_price, or -1.
+                if (nearest_trigger == -1 || last_trade_price < 0)
+                {
+                    return -1;
+                }
+                bool is_triggered = (side == order_side::BID) ? nearest_trigger <= last_trade_price : nearest_trigger >= last_trade_price;
+                return is_triggered ? nearest_trigger : -1;
+            }
+
+            orderbook::order* remove_priority_order(std::int64_t trigger_price)
+            {
+                orderbook::order* order = queues->remove_priority_order(trigger_price);
+                if (queues->is_empty(trigger_price))
+                {
+                    triggers->unset(trigger_price);
+                    if (trigger_price == nearest_trigger)
+                    {
+                        nearest_trigger = find_nearest_trigger(trigger_price);
+                    }
+                }
+                return order;
+            }
+
+            std::int64_t cancel_range(std::int64_t min_trigger, std::int64_t max_trigger)
+            {
+                // Cancels every stop with a trigger price in range. Returns the number of stops cancelled.
+                return cancel_levels(min_trigger, max_trigger, [&](std::int64_t trigger_price) {
+                    return queues->clear_level(trigger_price);
+                });
+            }
+
+            template <typename F>
+            std::int64_t cancel_orders_if(std::int64_t min_trigger, std::int64_t max_trigger, F&& should_cancel)
+            {
+                // As cancel_range, for the stops for which should_cancel(order) is true.
+                return cancel_levels(min_trigger, max_trigger, [&](std::int64_t trigger_price) {
+                    return queues->cancel_orders_if(trigger_price, should_cancel);
+                });
+            }
+
+            bool is_empty(std::int64_t trigger_price)
+            {
+                return queues->is_empty(trigger_price);
+            }
+
+            std::int64_t get_nearest_trigger()
+            {
+                return nearest_trigger;
+            }
+
+            std::int64_t get_total_volume_at_tick_level(std::int64_t trigger_price)
+            {
+                return queues->get_total_volume_at_tick_level(trigger_price);
+            }
+
+            std::int64_t get_resting_orders()
+            {
+                return queues->get_resting_orders();
+            }
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+
+namespace orderbook::matching {
+
+    // Allocation policies for orderbook::basic_book, deciding how an incoming order's volume is shared among the
+    // resting orders of a price level. Chosen at compile time, so the sweep carries no runtime policy branch.
+
+    struct price_time
+    {
+        // Strict FIFO within each level.
+        bool static constexpr is_pro_rata = false;
+        bool static constexpr has_top_order = false;
+    };
+
+    struct pro_rata
+    {
+        // Each order receives floor(volume * size / level volume). The lots lost to rounding are handed out one at a
+        // time in queue order, so the result is deterministic and the full volume is always allocated.
+        bool static constexpr is_pro_rata = true;
+        bool static constexpr has_top_order = false;
+
+        static std::int64_t share(std::int64_t volume, std::int64_t order_size, std::int64_t level_volume)
+        {
+            return static_cast<std::int64_t>(static_cast<__int128>(volume) * order_size / level_volume);
+        }
+    };
+
+    struct top_order_pro_rata : pro_rata
+    {
+        // The order that set a new best price is filled first, the rest of the volume is allocated pro rata.
+        bool static constexpr has_top_order = true;
+    };
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include "orderbook/enums/enums.h"
+#include "orderbook/trees/price_ladder.h"
+#include "orderbook/maps/order_map.h"
+
+namespace orderbook::matching {
+
+    // Compile-time description of one side of a book. The matching core is instantiated once per aggressor side,
+    // so choosing trees, maps and price comparisons costs nothing inside the sweep loop.
+
+    struct bid_side;
+    struct ask_side;
+
+    template <typename side>
+    struct side_traits;
+
+    template <>
+    struct side_traits<bid_side>
+    {
+        std::int64_t static constexpr side = order_side::BID;
+        using opposite = ask_side;
+
+        template <typename book>
+        static orderbook::trees::price_ladder* tree(book* b) { return b->bid_tree; }
+
+        template <typename book>
+        static orderbook::maps::order_map* map(book* b) { return b->bid_map; }
+
+        template <typename book>
+        static std::int64_t& top_order(book* b) { return b->bid_top_order; }
+
+        static std::int64_t best(orderbook::trees::price_ladder* tree) { return tree->get_best_value(); }
+
+        static bool is_better(std::int64_t price, std::int64_t than) { return price > than; }
+
+        static bool can_trade_at(std::int64_t limit_price, std::int64_t resting_price) { return limit_price >= resting_price; }
+
+        static std::int64_t volume_within(orderbook::maps::order_map* resting, std::int64_t limit_price)
+        {
+            // Asks at or below a buyer's limit.
+            return resting->get_volume_at_or_below(limit_price);
+        }
+    };
+
+    template <>
+    struct side_traits<ask_side>
+    {
+        std::int64_t static constexpr side = order_side::ASK;
+        using opposite = bid_side;
+
+        template <typename book>
+        static orderbook::trees::price_ladder* tree(book* b) { return b->ask_tree; }
+
+        template <typename book>
+        static orderbook::maps::order_map* map(book* b) { return b->ask_map; }
+
+        template <typename book>
+        static std::int64_t& top_order(book* b) { return b->ask_top_order; }
+
+        static std::int64_t best(orderbook::trees::price_ladder* tree) { return tree->get_best_value(); }
+
+        static bool is_better(std::int64_t price, std::int64_t than) { return price < than; }
+
+        static bool can_trade_at(std::int64_t limit_price, std::int64_t resting_price) { return limit_price <= resting_price; }
+
+        static std::int64_t volume_within(orderbook::maps::order_map* resting, std::int64_t limit_price)
+        {
+            // Bids at or above a seller's limit.
+            return resting->get_volume_at_or_above(limit_price);
+        }
+    };
+}
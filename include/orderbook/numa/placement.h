@@ -0,0 +1,173 @@
+#pragma once
+#include <iostream>
+#include <thread>
+#include <string>
+#include <filesystem>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "orderbook/orderbook/orderbook.h"
+
+namespace orderbook::numa {
+
+    struct memory_placement
+    {
+        const char* component;
+        std::int64_t regions;         // number of pools sampled for this component
+        std::int64_t regions_on_node; // pools whose first page is resident on the expected node
+    };
+
+    class book_placement
+    {
+        std::int64_t static constexpr MPOL_DEFAULT = 0;
+        std::int64_t static constexpr MPOL_PREFERRED = 1;
+        std::int64_t static constexpr MPOL_F_NODE = 1 << 0;
+        std::int64_t static constexpr MPOL_F_ADDR = 1 << 1;
+
+        public:
+            std::int64_t static constexpr N_COMPONENTS = 6;
+
+        private:
+            std::int64_t cpu;
+            std::int64_t node;
+
+            void sample(memory_placement& placement, const void* address)
+            {
+                placement.regions++;
+                if (node_of_address(address) == node)
+                {
+                    placement.regions_on_node++;
+                }
+            }
+
+            void sample_order_pools(memory_placement& placement, orderbook::maps::order_map* order_map)
+            {
+                for (std::int64_t i = 0; i < order_map->get_mempool_size(); i++)
+                {
+                    sample(placement, order_map->get_queue(i)->get_mempool());
+                }
+            }
+
+        public:
+            book_placement(std::int64_t cpu) : cpu(cpu), node(node_of_cpu(cpu)) {}
+
+            static std::int64_t node_of_cpu(std::int64_t cpu)
+            {
+                // sysfs links each cpu to its node as /sys/devices/system/cpu/cpuN/nodeK.
+                std::error_code ec;
+                std::filesystem::path cpu_path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+                for (const auto& entry : std::filesystem::directory_iterator(cpu_path, ec))
+                {
+                    std::string name = entry.path().filename().string();
+                    if (name.size() > 4 && name.compare(0, 4, "node") == 0)
+                    {
+                        return std::stoll(name.substr(4));
+                    }
+                }
+                return 0; // kernels without NUMA support expose a single node.
+            }
+
+            static std::int64_t node_of_address(const void* address)
+            {
+                int address_node = -1;
+                long result = syscall(SYS_get_mempolicy, &address_node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR);
+                return (result == 0) ? address_node : -1;
+            }
+
+            static bool pin_current_thread(std::int64_t cpu)
+            {
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(cpu, &cpu_set);
+                return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+            }
+
+            static bool unpin_grower(orderbook::pools::pool_grower* grower, std::int64_t node, std::int64_t cpu)
+            {
+                // The grower inherits the builder's pin to the matching cpu. Move it to the node's other cpus, or any
+                // other cpu when the node has none, so background growth does not compete with matching.
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                std::int64_t n_cpus = std::thread::hardware_concurrency();
+                for (std::int64_t i = 0; i < n_cpus; i++)
+                {
+                    if (i != cpu && node_of_cpu(i) == node) CPU_SET(i, &cpu_set);
+                }
+                for (std::int64_t i = 0; i < n_cpus && CPU_COUNT(&cpu_set) == 0; i++)
+                {
+                    if (i != cpu) CPU_SET(i, &cpu_set);
+                }
+                if (CPU_COUNT(&cpu_set) == 0)
+                {
+                    return false; // a single cpu, there is nowhere else to run.
+                }
+                return pthread_setaffinity_np(grower->get_native_handle(), sizeof(cpu_set), &cpu_set) == 0;
+            }
+
+            std::int64_t get_cpu()
+            {
+                return cpu;
+            }
+
+            std::int64_t get_node()
+            {
+                return node;
+            }
+
+            orderbook::book* make_book(std::int64_t n_tick_levels)
+            {
+                // Construct the book on a thread pinned to the matching core with a preferred memory policy for
+                // its node. Every pool is eagerly allocated and touched in the constructor, so first touch places
+                // the trees, maps, order pools and ingress queues on that node. The book's grower thread keeps the
+                // memory policy, so later chunks land on the node too, but is moved off the matching cpu.
+                orderbook::book* ob = nullptr;
+                std::thread builder([&]() {
+                    if (!pin_current_thread(cpu))
+                    {
+                        std::cout << "FAILED TO PIN BOOK CONSTRUCTION TO CPU: " << cpu << "\n";
+                    }
+                    unsigned long node_mask[16] = {0};
+                    node_mask[node / 64] |= 1UL << (node % 64);
+                    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, node_mask, sizeof(node_mask) * 8) != 0)
+                    {
+                        std::cout << "FAILED TO SET MEMORY POLICY FOR NODE: " << node << "\n";
+                    }
+                    ob = new orderbook::book{n_tick_levels};
+                    syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+                });
+                builder.join();
+                unpin_grower(ob->grower, node, cpu);
+                return ob;
+            }
+
+            void report(orderbook::book* ob, memory_placement (&placements)[N_COMPONENTS])
+            {
+                placements[0] = {"bid tree nodes", 0, 0};
+                placements[1] = {"ask tree nodes", 0, 0};
+                placements[2] = {"bid ingress queues", 0, 0};
+                placements[3] = {"ask ingress queues", 0, 0};
+                placements[4] = {"bid order pools", 0, 0};
+                placements[5] = {"ask order pools", 0, 0};
+                sample(placements[0], ob->bid_tree->get_memory_pool());
+                sample(placements[1], ob->ask_tree->get_memory_pool());
+                sample(placements[2], ob->bid_map->get_queue(0));
+                sample(placements[3], ob->ask_map->get_queue(0));
+                sample_order_pools(placements[4], ob->bid_map);
+                sample_order_pools(placements[5], ob->ask_map);
+            }
+
+            void print_report(orderbook::book* ob)
+            {
+                memory_placement placements[N_COMPONENTS];
+                report(ob, placements);
+                std::cout << "BOOK MEMORY PLACEMENT, CPU: " << cpu << " NODE: " << node << "\n";
+                std::cout << "--------------------------------\n";
+                for (std::int64_t i = 0; i < N_COMPONENTS; i++)
+                {
+                    std::cout << placements[i].component << " | " << placements[i].regions_on_node << "/" << placements[i].regions << " on node\n";
+                }
+                std::cout << "--------------------------------\n";
+            }
+    };
+}
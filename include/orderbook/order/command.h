@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include "orderbook/enums/enums.h"
+
+namespace orderbook
+{
+    struct command
+    {
+        // One entry of a batch passed to book::add_orders. Fields a given action does not use are ignored.
+        std::int64_t action;            // command_action
+        std::int64_t order_id;          // order to cancel or modify.
+        std::int64_t tick_level;
+        std::int64_t order_side;
+        std::int64_t order_size;
+        std::int64_t order_type;
+        std::int64_t order_limit_price;
+        std::int64_t expiry_time;
+        std::int64_t display_size;
+        std::int64_t owner;             // -1 for none, see book::cancel_owner.
+
+        static command add(std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price = -1, std::int64_t expiry_time = -1, std::int64_t display_size = -1, std::int64_t owner = -1)
+        {
+            return {command_action::COMMAND_ADD, -1, tick_level, order_side, order_size, order_type, order_limit_price, expiry_time, display_size, owner};
+        }
+
+        static command cancel(std::int64_t order_id)
+        {
+            return {command_action::COMMAND_CANCEL, order_id, -1, 0, 0, -1, -1, -1, -1, -1};
+        }
+
+        static command modify(std::int64_t order_id, std::int64_t new_size, std::int64_t new_price)
+        {
+            return {command_action::COMMAND_MODIFY, order_id, new_price, 0, new_size, -1, -1, -1, -1, -1};
+        }
+
+        static command match()
+        {
+            return {command_action::COMMAND_MATCH, -1, -1, 0, 0, -1, -1, -1, -1, -1};
+        }
+    };
+}
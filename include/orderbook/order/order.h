@@ -1,3 +1,4 @@
+#pragma once
 #include "orderbook/enums/enums.h"
 
 namespace orderbook 
@@ -5,30 +6,56 @@ namespace orderbook
     class order
     {
         public:
+            std::int64_t static constexpr NOT_REDUCED = -2;
+
             std::int64_t order_size;
             std::int64_t order_side;
             std::int64_t order_id;
             std::int64_t order_type;
             std::int64_t order_limit_price;
+            std::int64_t order_reserve;      // hidden quantity of an iceberg order, not part of order_size.
+            std::int64_t order_display_size; // size of each visible slice of an iceberg order.
+            std::int64_t order_queue_offset; // volume queued at the level before this order, over the queue's lifetime.
+            std::int64_t order_next_reduced; // next sequence in the queue's reduced list, -1 at the end, NOT_REDUCED if not listed.
 
             order(std::int64_t order_side, std::int64_t order_size) : 
-                order_side(order_side), order_size(order_size), order_id(-1), order_type(-1), order_limit_price(-1) {};
+                order_side(order_side), order_size(order_size), order_id(-1), order_type(-1), order_limit_price(-1),
+                order_reserve(0), order_display_size(0), order_queue_offset(0), order_next_reduced(NOT_REDUCED) {};
 
-            void set_market_order_attributes(std::int64_t id, std::int64_t size, std::int64_t side)
+            void set_order_attributes(std::int64_t id, std::int64_t size, std::int64_t side, std::int64_t type, std::int64_t limit_price)
             {
                 order_id = id;
                 order_size = size;
                 order_side = side;
-                order_type = order_type::ORDER_MARKET; // limit/market
+                order_type = type;
+                order_limit_price = limit_price;
+                order_reserve = 0;
+                order_display_size = 0;
+                order_next_reduced = NOT_REDUCED;
             }
-            
-            void set_limit_order_attributes(std::int64_t id, std::int64_t size, std::int64_t side, std::int64_t limit_price)
+
+            void set_reserve(std::int64_t reserve, std::int64_t display_size)
             {
-                order_id = id;
-                order_size = size;
-                order_side = side;
-                order_limit_price = limit_price;
-                order_type = order_type::ORDER_STOP_LIMIT; // stop limit order
+                order_reserve = reserve;
+                order_display_size = display_size;
+            }
+
+            void cancel()
+            {
+                // Cancelled orders stay in their slot until they reach the front of the queue, where they are skipped.
+                order_id = -1;
+                order_size = 0;
+                order_reserve = 0;
+            }
+
+            bool is_cancelled()
+            {
+                return order_id == -1;
+            }
+
+            void reduce_reserve(std::int64_t size)
+            {
+                order_reserve -= size;
             }
 
             void reduce_size(std::int64_t size_of_match)
@@ -59,6 +86,16 @@ namespace orderbook
             std::int64_t get_limit_price() {
                 return order_limit_price;
             }
+
+            std::int64_t get_reserve()
+            {
+                return order_reserve;
+            }
+
+            std::int64_t get_display_size()
+            {
+                return order_display_size;
+            }
             
             ~order()
             {
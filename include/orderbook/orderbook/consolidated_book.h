@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "orderbook/orderbook/mbp_book.h"
+#include "orderbook/trees/indexed_heap.h"
+#include "orderbook/events/event_buffer.h"
+
+namespace orderbook
+{
+    class consolidated_book;
+
+    struct venue_feed
+    {
+        // Context passed to a venue's level handler, so one static handler serves every venue.
+        consolidated_book* consolidator;
+        std::int64_t venue;
+    };
+
+    class consolidated_book
+    {
+        // The consolidated BBO and merged depth of one instrument traded on several venues, each its own book on a
+        // shared tick grid. Every venue's level events are mirrored into a market-by-price book, and each side keeps
+        // a heap of venues keyed by their best price, so the consolidated best is the top of the heap and is updated
+        // only when a venue's own best moves. Merged depth is a k-way merge of the venues' top levels.
+        std::int64_t static constexpr NO_LEVEL = INT64_MAX; // key of a venue with nothing on a side.
+
+        private:
+            orderbook::mbp_book** venues;
+            venue_feed* feeds;
+            orderbook::trees::indexed_heap* best_bids; // keyed by -best bid, the highest bid is on top.
+            orderbook::trees::indexed_heap* best_asks;
+            orderbook::trees::indexed_heap* merge; // scratch for get_depth.
+            orderbook::maps::price_level* venue_depth; // scratch for get_depth, max_depth levels per venue.
+            std::int64_t* cursors;
+            std::int64_t* venue_levels;
+            std::int64_t n_venues;
+            std::int64_t n_tick_levels;
+            std::int64_t max_depth;
+
+            static std::int64_t key(std::int64_t order_side, std::int64_t tick_level)
+            {
+                if (tick_level < 0) return NO_LEVEL;
+                return (order_side == order_side::BID) ? -tick_level : tick_level;
+            }
+
+            orderbook::trees::indexed_heap* get_heap(std::int64_t order_side)
+            {
+                return (order_side == order_side::BID) ? best_bids : best_asks;
+            }
+
+            std::int64_t get_best(std::int64_t order_side)
+            {
+                orderbook::trees::indexed_heap* heap = get_heap(order_side);
+                if (heap->get_top_key() == NO_LEVEL) return -1;
+                return (order_side == order_side::BID) ? -heap->get_top_key() : heap->get_top_key();
+            }
+
+            std::int64_t next_merge_key(std::int64_t order_side, std::int64_t venue)
+            {
+                if (cursors[venue] == venue_levels[venue]) return NO_LEVEL;
+                return key(order_side, venue_depth[venue * max_depth + cursors[venue]].tick_level);
+            }
+
+        public:
+            consolidated_book(std::int64_t n_venues, std::int64_t n_tick_levels, std::int64_t max_depth = 10) :
+                n_venues(n_venues), n_tick_levels(n_tick_levels), max_depth(max_depth)
+            {
+                venues = static_cast<orderbook::mbp_book**>(std::malloc(n_venues * sizeof(orderbook::mbp_book*)));
+                feeds = static_cast<venue_feed*>(std::malloc(n_venues * sizeof(venue_feed)));
+                for (std::int64_t i = 0; i < n_venues; i++)
+                {
+                    venues[i] = new orderbook::mbp_book{n_tick_levels};
+                    feeds[i] = {this, i};
+                }
+                best_bids = new orderbook::trees::indexed_heap{n_venues, NO_LEVEL};
+                best_asks = new orderbook::trees::indexed_heap{n_venues, NO_LEVEL};
+                merge = new orderbook::trees::indexed_heap{n_venues, NO_LEVEL};
+                venue_depth = static_cast<orderbook::maps::price_level*>(std::malloc(n_venues * max_depth * sizeof(orderbook::maps::price_level)));
+                cursors = static_cast<std::int64_t*>(std::calloc(n_venues, sizeof(std::int64_t)));
+                venue_levels = static_cast<std::int64_t*>(std::calloc(n_venues, sizeof(std::int64_t)));
+            }
+
+            ~consolidated_book()
+            {
+                for (std::int64_t i = 0; i < n_venues; i++)
+                {
+                    delete venues[i];
+                }
+                std::free(venues);
+                std::free(feeds);
+                delete best_bids;
+                delete best_asks;
+                delete merge;
+                std::free(venue_depth);
+                std::free(cursors);
+                std::free(venue_levels);
+            }
+
+            template <typename book>
+            void attach(book* b, std::int64_t venue)
+            {
+                // Loads the levels already resting in venue's book, then subscribes to its level events, replacing
+                // any level handler it had.
+                load_levels(venue, order_side::BID, b->bid_tree, b->bid_map);
+                load_levels(venue, order_side::ASK, b->ask_tree, b->ask_map);
+                b->set_level_handler(on_level_events, feeds + venue);
+            }
+
+            template <typename tree, typename map>
+            void load_levels(std::int64_t venue, std::int64_t order_side, tree* levels, map* volumes)
+            {
+                for (std::int64_t tick_level = levels->find_next_level(0); tick_level != -1; tick_level = levels->find_next_level(tick_level + 1))
+                {
+                    apply(venue, {order_side, tick_level, volumes->get_total_volume_at_tick_level(tick_level)});
+                }
+            }
+
+            static void on_level_events(const orderbook::events::level_event* events, std::int64_t n_events, void* context)
+            {
+                venue_feed* feed = static_cast<venue_feed*>(context);
+                for (std::int64_t i = 0; i < n_events; i++)
+                {
+                    feed->consolidator->apply(feed->venue, events[i]);
+                }
+            }
+
+            void apply(std::int64_t venue, const orderbook::events::level_event& event)
+            {
+                // Each venue counts once as an order at every level it quotes, so merged depth reports venues per level.
+                orderbook::mbp_book* mirror = venues[venue];
+                if (!mirror->set_level(event.order_side, event.tick_level, event.volume, 1))
+                {
+                    return;
+                }
+                std::int64_t best = mirror->get_side(event.order_side)->get_best();
+                orderbook::trees::indexed_heap* heap = get_heap(event.order_side);
+                if (heap->get_key(venue) != key(event.order_side, best))
+                {
+                    heap->update(venue, key(event.order_side, best));
+                }
+            }
+
+            std::int64_t get_best_bid()
+            {
+                return get_best(order_side::BID);
+            }
+
+            std::int64_t get_best_ask()
+            {
+                return get_best(order_side::ASK);
+            }
+
+            std::int64_t get_best_venue(std::int64_t order_side)
+            {
+                // One of the venues at the consolidated best, -1 if no venue has a level on order_side.
+                orderbook::trees::indexed_heap* heap = get_heap(order_side);
+                return (heap->get_top_key() == NO_LEVEL) ? -1 : heap->get_top();
+            }
+
+            std::int64_t get_total_volume_at_tick_level(std::int64_t order_side, std::int64_t tick_level)
+            {
+                std::int64_t total = 0;
+                for (std::int64_t i = 0; i < n_venues; i++)
+                {
+                    total += venues[i]->get_total_volume_at_tick_level(order_side, tick_level);
+                }
+                return total;
+            }
+
+            std::int64_t get_depth(std::int64_t order_side, std::int64_t max_levels, orderbook::maps::price_level* out)
+            {
+                // Writes up to max_levels merged levels from the best outwards, at most max_depth, and returns how
+                // many were written. Volumes at the same price are summed across venues.
+                max_levels = std::min(max_levels, max_depth);
+                for (std::int64_t i = 0; i < n_venues; i++)
+                {
+                    venue_levels[i] = venues[i]->get_depth(order_side, max_levels, venue_depth + i * max_depth);
+                    cursors[i] = 0;
+                    merge->update(i, next_merge_key(order_side, i));
+                }
+                std::int64_t n = 0;
+                while (n < max_levels && merge->get_top_key() != NO_LEVEL)
+                {
+                    std::int64_t level_key = merge->get_top_key();
+                    out[n] = {venue_depth[merge->get_top() * max_depth + cursors[merge->get_top()]].tick_level, 0, 0};
+                    while (merge->get_top_key() == level_key)
+                    {
+                        std::int64_t venue = merge->get_top();
+                        const orderbook::maps::price_level& level = venue_depth[venue * max_depth + cursors[venue]];
+                        out[n].volume += level.volume;
+                        out[n].n_orders += level.n_orders;
+                        cursors[venue]++;
+                        merge->update(venue, next_merge_key(order_side, venue));
+                    }
+                    n++;
+                }
+                return n;
+            }
+
+            orderbook::mbp_book* get_venue(std::int64_t venue)
+            {
+                return venues[venue];
+            }
+
+            std::int64_t get_n_venues()
+            {
+                return n_venues;
+            }
+    };
+}
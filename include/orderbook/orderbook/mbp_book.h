@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include "orderbook/maps/level_map.h"
+
+namespace orderbook
+{
+    class mbp_book
+    {
+        // A market-by-price book for feeds that only publish price level updates. Each side is a flat array of
+        // aggregated volume and order count plus an occupancy bitmap, 16 bytes and one bit per tick level, with no
+        // trees, queues or order pools. Nothing is matched, the book mirrors the levels it is given.
+        public:
+            orderbook::maps::level_map* bids;
+            orderbook::maps::level_map* asks;
+            std::int64_t n_tick_levels;
+
+            mbp_book(std::int64_t n) : n_tick_levels(n)
+            {
+                bids = new orderbook::maps::level_map{n_tick_levels, order_side::BID};
+                asks = new orderbook::maps::level_map{n_tick_levels, order_side::ASK};
+            }
+
+            ~mbp_book()
+            {
+                delete bids;
+                delete asks;
+            }
+
+            orderbook::maps::level_map* get_side(std::int64_t order_side)
+            {
+                return (order_side == order_side::BID) ? bids : asks;
+            }
+
+            bool set_level(std::int64_t order_side, std::int64_t tick_level, std::int64_t volume, std::int64_t n_orders)
+            {
+                // Returns false for a tick level out of bounds, the update is dropped.
+                if (tick_level < 0 || tick_level >= n_tick_levels)
+                {
+                    return false;
+                }
+                get_side(order_side)->set_level(tick_level, volume, n_orders);
+                return true;
+            }
+
+            bool add_to_level(std::int64_t order_side, std::int64_t tick_level, std::int64_t volume, std::int64_t n_orders)
+            {
+                if (tick_level < 0 || tick_level >= n_tick_levels)
+                {
+                    return false;
+                }
+                get_side(order_side)->add_to_level(tick_level, volume, n_orders);
+                return true;
+            }
+
+            std::int64_t get_best_bid()
+            {
+                return bids->get_best();
+            }
+
+            std::int64_t get_best_ask()
+            {
+                return asks->get_best();
+            }
+
+            std::int64_t get_total_volume_at_tick_level(std::int64_t order_side, std::int64_t tick_level)
+            {
+                return get_side(order_side)->get_total_volume_at_tick_level(tick_level);
+            }
+
+            std::int64_t get_order_count_at_tick_level(std::int64_t order_side, std::int64_t tick_level)
+            {
+                return get_side(order_side)->get_order_count_at_tick_level(tick_level);
+            }
+
+            std::int64_t get_depth(std::int64_t order_side, std::int64_t max_levels, orderbook::maps::price_level* out)
+            {
+                return get_side(order_side)->get_depth(max_levels, out);
+            }
+    };
+}
@@ -1,128 +1,822 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
-#include "orderbook/trees/avl_tree.h"
+#include "orderbook/trees/price_ladder.h"
+#include "orderbook/maps/stop_map.h"
+#include "orderbook/maps/order_index.h"
+#include "orderbook/timers/timing_wheel.h"
+#include "orderbook/events/event_buffer.h"
+#include "orderbook/order/command.h"
+#include "orderbook/matching/policies.h"
+#include "orderbook/matching/side_traits.h"
 
 namespace orderbook
 {
-    class book
+    struct book_stats
+    {
+        std::int64_t bid_levels;
+        std::int64_t ask_levels;
+        std::int64_t bid_nodes_in_use;
+        std::int64_t bid_node_capacity;
+        std::int64_t ask_nodes_in_use;
+        std::int64_t ask_node_capacity;
+        std::int64_t bid_resting_orders;
+        std::int64_t ask_resting_orders;
+        std::int64_t bid_stop_orders;
+        std::int64_t ask_stop_orders;
+        std::int64_t queue_growths;
+        std::int64_t queue_growths_on_matching_thread;
+        std::int64_t dropped_orders;
+        std::int64_t pending_expiries;
+    };
+
+    template <typename matching_policy = orderbook::matching::price_time>
+    class basic_book
     {
         public:
-            orderbook::trees::avl_tree* bid_tree;
-            orderbook::trees::avl_tree* ask_tree;
+            orderbook::trees::price_ladder* bid_tree;
+            orderbook::trees::price_ladder* ask_tree;
             orderbook::maps::order_map* bid_map;
             orderbook::maps::order_map* ask_map;
+            orderbook::maps::stop_map* bid_stops;
+            orderbook::maps::stop_map* ask_stops;
+            orderbook::maps::order_index* index;
+            orderbook::timers::timing_wheel* expiries;
+            orderbook::events::event_buffer<orderbook::events::fill_event>* fills;
+            orderbook::events::event_buffer<orderbook::events::mass_cancel_event>* mass_cancels;
+            orderbook::events::event_buffer<orderbook::events::level_event>* level_events; // only fed once a level handler is set.
+            orderbook::pools::pool_grower* grower;
             std::int64_t id;
             std::int64_t n_tick_levels;
+            std::int64_t last_trade_price;
+            bool triggering_stops;
+            bool auction_mode;
+            std::int64_t* auction_demand; // scratch for uncross(): bid volume at or above each level.
+            std::int64_t* auction_supply; // scratch for uncross(): ask volume at or below each level.
+            orderbook::telemetry::counter dropped_orders;
 
-            book(std::int64_t n)
+            std::int64_t bid_top_order; // last order to set a new best bid, used by top order policies.
+            std::int64_t ask_top_order;
+
+            basic_book(std::int64_t n)
             {
+                bid_top_order = -1;
+                ask_top_order = -1;
                 id = 0;
                 n_tick_levels = n;
-                bid_tree = new orderbook::trees::avl_tree{n_tick_levels};
-                ask_tree = new orderbook::trees::avl_tree{n_tick_levels};
-                bid_map = new orderbook::maps::order_map{n_tick_levels};
-                ask_map = new orderbook::maps::order_map{n_tick_levels};
+                last_trade_price = -1;
+                triggering_stops = false;
+                auction_mode = false;
+                auction_demand = static_cast<std::int64_t*>(std::calloc(n_tick_levels, sizeof(std::int64_t)));
+                auction_supply = static_cast<std::int64_t*>(std::calloc(n_tick_levels, sizeof(std::int64_t)));
+                grower = new orderbook::pools::pool_grower{}; // prepares the next chunk of any pool crossing its high-water mark.
+                bid_tree = new orderbook::trees::price_ladder{n_tick_levels, order_side::BID, grower};
+                ask_tree = new orderbook::trees::price_ladder{n_tick_levels, order_side::ASK, grower};
+                bid_map = new orderbook::maps::order_map{n_tick_levels, grower};
+                ask_map = new orderbook::maps::order_map{n_tick_levels, grower};
+                bid_stops = new orderbook::maps::stop_map{n_tick_levels, order_side::BID, grower};
+                ask_stops = new orderbook::maps::stop_map{n_tick_levels, order_side::ASK, grower};
+                index = new orderbook::maps::order_index{grower};
+                expiries = new orderbook::timers::timing_wheel{4096, grower}; // timers in chunks of 4096 pending expiries.
+                fills = new orderbook::events::event_buffer<orderbook::events::fill_event>{1024, print_fills, nullptr};
+                mass_cancels = new orderbook::events::event_buffer<orderbook::events::mass_cancel_event>{16, print_mass_cancels, nullptr};
+                level_events = new orderbook::events::event_buffer<orderbook::events::level_event>{1024, nullptr, nullptr};
             }
 
             bool can_match_market_orders(std::int64_t price, bool is_bid_order) {
-                bool orders_exist_on_othr_side = is_bid_order ? !ask_tree->is_empty() : !bid_tree->is_empty();
-                if(orders_exist_on_othr_side){
-                    bool bid_condition = is_bid_order && price >= ask_tree->get_min_value();
-                    std::cout << "BID MAX VALUE: " << bid_tree->get_max_value() << "\n";
-                    bool ask_condition = !is_bid_order && bid_tree->get_max_value() >= price;
-                    return (bid_condition || ask_condition);
+                return is_bid_order ? can_sweep<orderbook::matching::bid_side>(price) : can_sweep<orderbook::matching::ask_side>(price);
+            }
+
+            template <typename side>
+            bool can_sweep(std::int64_t price) {
+                // True while the best opposite price is within an aggressor's limit of price.
+                using resting = orderbook::matching::side_traits<typename orderbook::matching::side_traits<side>::opposite>;
+                orderbook::trees::price_ladder* target_tree = resting::tree(this);
+                return !target_tree->is_empty() && orderbook::matching::side_traits<side>::can_trade_at(price, resting::best(target_tree));
+            }
+
+            template <typename resting_side>
+            std::int64_t sweep_level(std::int64_t id, orderbook::maps::order_map* target_queue, std::int64_t price, std::int64_t order_size) {
+                // Fill as much of order_size as the level at price holds. Orders the aggressor consumes whole are retired
+                // in one batch; only a partially filled order or an iceberg needing a new slice is handled on its own.
+                // The resting order was in the book first, so its price is the execution price. Returns the unfilled size.
+                if constexpr (matching_policy::has_top_order) {
+                    order_size = fill_top_order<resting_side>(id, target_queue, price, order_size);
                 }
-                return false;
+                if constexpr (matching_policy::is_pro_rata) {
+                    // A level the order consumes entirely is filled the same under any policy, FIFO retires it in bulk.
+                    if (order_size > 0 && order_size < target_queue->get_total_volume_at_tick_level(price)) {
+                        return allocate_pro_rata(id, target_queue, price, order_size);
+                    }
+                }
+                auto on_fill = [&](orderbook::order* filled) {
+                    record_fill(id, filled->get_order_id(), price, filled->get_size());
+                };
+                if (!target_queue->has_icebergs(price)) {
+                    // A plain level: one batch, then at most a partial fill of the order that did not fit.
+                    order_size -= target_queue->fill_priority_orders<false>(price, order_size, on_fill);
+                    if (order_size > 0 && !target_queue->is_empty(price)) {
+                        record_fill(id, target_queue->get_priority_order(price)->get_order_id(), price, order_size);
+                        target_queue->partial_fill_priority(price, order_size);
+                        order_size = 0;
+                    }
+                    return order_size;
+                }
+                while (order_size > 0 && !target_queue->is_empty(price)) {
+                    order_size -= target_queue->fill_priority_orders(price, order_size, on_fill);
+                    if (order_size == 0 || target_queue->is_empty(price)) break;
+
+                    orderbook::order* best_order = target_queue->get_priority_order(price);
+                    if (order_size < best_order->get_size()) {
+                        // Incoming order size is less than the best price level order size (partial fill of best order).
+                        record_fill(id, best_order->get_order_id(), price, order_size);
+                        target_queue->partial_fill_priority(price, order_size);
+                        order_size = 0;
+                    } else {
+                        // An iceberg slice used up, its next slice goes to the back of the level.
+                        record_fill(id, best_order->get_order_id(), price, best_order->get_size());
+                        order_size -= best_order->get_size();
+                        remove_filled_order(target_queue, price);
+                    }
+                }
+                return order_size;
             }
 
-            void execute_market_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type) {
-                // Immediately executed against the best available price in the opposite side of the order book (bids for sell orders, asks for buy orders).
-                // Sweep book till order filled or no more orders in book.
+            template <typename resting_side>
+            std::int64_t fill_top_order(std::int64_t id, orderbook::maps::order_map* target_queue, std::int64_t price, std::int64_t order_size) {
+                // The top order keeps its priority until it is fully filled.
+                std::int64_t top_order = orderbook::matching::side_traits<resting_side>::top_order(this);
+                if (order_size == 0 || target_queue->is_empty(price)) return order_size;
+                orderbook::order* top = target_queue->get_priority_order(price);
+                if (top->get_order_id() != top_order) return order_size;
+                std::int64_t size_of_match = std::min(order_size, top->get_size());
+                fill_resting_order(id, target_queue, price, target_queue->get_queue(price)->get_tail(), size_of_match);
+                return order_size - size_of_match;
+            }
+
+            std::int64_t allocate_pro_rata(std::int64_t id, orderbook::maps::order_map* target_queue, std::int64_t price, std::int64_t order_size) {
+                // order_size is below the level volume, so every order gets less than its size in the first pass and
+                // the rounding remainder, fewer lots than there are orders, is handed out one lot each in the second.
+                orderbook::queues::ring_buffer* queue = target_queue->get_queue(price);
+                std::int64_t level_volume = queue->get_total_volume();
+                std::int64_t volume = order_size;
+                std::int64_t first = queue->get_tail();
+                std::int64_t last = queue->get_head(); // replenished iceberg slices queue beyond last and are not allocated again.
+                for (std::int64_t sequence = first; sequence < last; sequence++) {
+                    if (!queue->is_live(sequence)) continue;
+                    std::int64_t share = matching_policy::share(volume, queue->at(sequence)->get_size(), level_volume);
+                    if (share > 0) {
+                        fill_resting_order(id, target_queue, price, sequence, share);
+                        order_size -= share;
+                    }
+                }
+                for (std::int64_t sequence = first; sequence < last && order_size > 0; sequence++) {
+                    if (!queue->is_live(sequence)) continue;
+                    fill_resting_order(id, target_queue, price, sequence, 1);
+                    order_size--;
+                }
+                return order_size;
+            }
+
+            void fill_resting_order(std::int64_t id, orderbook::maps::order_map* target_queue, std::int64_t price, std::int64_t sequence, std::int64_t size_of_match) {
+                orderbook::order* resting = target_queue->get_queue(price)->at(sequence);
+                record_fill(id, resting->get_order_id(), price, size_of_match);
+                if (size_of_match < resting->get_size()) {
+                    target_queue->partial_fill_order(price, sequence, size_of_match);
+                } else {
+                    remove_filled_order(target_queue, price, sequence);
+                }
+            }
+
+            std::int64_t sweep_opposite_side(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size) {
+                // Match an incoming order against the best prices on the opposite side of the book (asks for buy orders, bids for sell orders)
+                // while they are at or better than tick_level. Returns the unfilled size.
                 // Slippage can occur when we sweep up or down price levels to fill the order.
-                bool order_filled = false;
-                std::int64_t initial_size = order_size;
-                bool is_bid_order = (order_side == order_side::BID);
+                // The price index is only consulted once per level, however many orders the level holds.
+                // Nothing trades on arrival during an auction, orders rest until uncross().
+                if (auction_mode) return order_size;
+                if (order_side == order_side::BID) {
+                    return sweep<orderbook::matching::bid_side>(id, tick_level, order_size);
+                }
+                return sweep<orderbook::matching::ask_side>(id, tick_level, order_size);
+            }
 
-                orderbook::trees::avl_tree* target_tree = is_bid_order ? ask_tree : bid_tree;
-                orderbook::maps::order_map* target_queue = is_bid_order ? ask_map : bid_map;
+            template <typename side>
+            std::int64_t sweep(std::int64_t id, std::int64_t tick_level, std::int64_t order_size) {
+                // One instantiation per aggressor side, the side is resolved once on entry rather than on every level.
+                using aggressor = orderbook::matching::side_traits<side>;
+                using resting_side = typename aggressor::opposite;
+                using resting = orderbook::matching::side_traits<resting_side>;
+                orderbook::trees::price_ladder* target_tree = resting::tree(this);
+                orderbook::maps::order_map* target_queue = resting::map(this);
 
-                std::cout << "MARKET ORDER: Price: " << tick_level << " Size: " << initial_size << " is bid order: " << is_bid_order << "\n";
+                while (order_size > 0 && !target_tree->is_empty()) {
+                    // Continue sweeping while price levels exist and the best one is within the limit.
+                    std::int64_t best_price = resting::best(target_tree);
+                    if (!aggressor::can_trade_at(tick_level, best_price)) break;
+                    order_size = sweep_level<resting_side>(id, target_queue, best_price, order_size);
+                    last_trade_price = best_price;
+                    remove_empty_level<resting_side>(best_price); // check the best level is empty after matching, if so remove it
+                }
+                return order_size;
+            }
 
-                while (!order_filled && can_match_market_orders(tick_level, is_bid_order)) { 
-                    // Continue sweeping while price levels exist.
-                
-                    std::int64_t best_price = is_bid_order ? target_tree->get_min_value() : target_tree->get_max_value(); // Get the best price (min for ask, max for bid).                    
-                    orderbook::order* best_order = target_queue->get_priority_order(best_price);
+            void record_fill(std::int64_t aggressor_id, std::int64_t resting_id, std::int64_t price, std::int64_t size) {
+                fills->push({aggressor_id, resting_id, price, size});
+            }
 
-                    std::cout << "CHCKING MARKET ORDER CONDITIONS\n";
-                
-                    if (handle_stop_limit(best_order, best_price) || handle_fill_or_kill(best_order, best_price, target_queue->get_total_volume_at_tick_level(best_price))) {
-                        continue;
-                    }
+            void flush_events() {
+                fills->flush();
+                level_events->flush();
+                mass_cancels->flush();
+            }
 
-                    if(order_size < best_order->get_size()) {
-                        // Market order size is less than the best price level order size (partial fill of best order).
-                        target_queue->partial_fill_priority(best_price, order_size);
-                        order_filled = true;
-                        std::cout << "Market order and best match partial filled, BEST MATCH SIZE: " << best_order->get_size() << " ORDER SIZE: " << order_size << "\n";
-                    } else {
-                        
-                        if (order_size > best_order->get_size()) {
-                            // Market order size is greater than the best price level order size (partial fill of market order).
-                            // Remove fully filled best order.
-                            order_size -= best_order->get_size();
-                            std::cout << "Market order partial fill and best match filled, BEST MATCH SIZE: " << best_order->get_size() << " ORDER SIZE: " << order_size << "\n";
-                        } else {
-                            // Market order size equals the best price level order size (full fill for both).
-                            order_filled = true;
-                            std::cout << "Market order and best match filled\n";
-                        }
-                        target_queue->remove_priority_order(best_price);
-                    }
-                    
-                    if(is_bid_order) {
-                        remove_empty_ask_level(best_price); // check the best ask is empty after matching, if so remove it
-                    } else {
-                        remove_empty_bid_level(best_price); // check the best bid is empty after matching, if so remove it
-                    };
+            static void print_fills(const orderbook::events::fill_event* events, std::int64_t n_events, void*) {
+                // Default fill handler, replaced with set_fill_handler().
+                for (std::int64_t i = 0; i < n_events; i++) {
+                    std::cout << "Order: " << events[i].aggressor_id << " matched with Resting Order: " << events[i].resting_id
+                              << " at Price: " << events[i].price << " Size: " << events[i].size << "\n";
+                }
+            }
+
+            void set_fill_handler(orderbook::events::event_buffer<orderbook::events::fill_event>::handler handler, void* context) {
+                fills->set_handler(handler, context);
+            }
+
+            static void print_mass_cancels(const orderbook::events::mass_cancel_event* events, std::int64_t n_events, void*) {
+                for (std::int64_t i = 0; i < n_events; i++) {
+                    std::cout << "Mass Cancel: " << ((events[i].order_side == order_side::BID) ? "bid" : "ask") << " levels "
+                              << events[i].min_tick_level << " to " << events[i].max_tick_level << " Owner: " << events[i].owner
+                              << " Orders: " << events[i].orders << " Volume: " << events[i].volume << "\n";
                 }
+            }
 
-                if (!order_filled) {
+            void set_level_handler(orderbook::events::event_buffer<orderbook::events::level_event>::handler handler, void* context) {
+                // Level changes are published in the same batches as fills, one event per change to a level's visible
+                // volume. Until a handler is set the maps do not produce them at all.
+                level_events->set_handler(handler, context);
+                bid_map->publish_level_changes(handler == nullptr ? nullptr : level_events, order_side::BID);
+                ask_map->publish_level_changes(handler == nullptr ? nullptr : level_events, order_side::ASK);
+            }
+
+            void set_mass_cancel_handler(orderbook::events::event_buffer<orderbook::events::mass_cancel_event>::handler handler, void* context) {
+                mass_cancels->set_handler(handler, context);
+            }
+
+            void execute_market_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type) {
+                // Immediately executed against the best available price in the opposite side of the order book.
+                // Sweep book till order filled or no more orders in book.
+                std::int64_t initial_size = order_size;
+
+                std::cout << "MARKET ORDER: Price: " << tick_level << " Size: " << initial_size << " is bid order: " << (order_side == order_side::BID) << "\n";
+
+                order_size = sweep_opposite_side(id, tick_level, order_side, order_size);
+
+                if (order_size > 0) {
                     if (order_size < initial_size) {
                         std::cout << "Market Order Partial Fill\n"; 
                     } else {
                         std::cout << "Market Order Not Filled - Added To Book as Limit Order\n"; 
                     }
-                    add_to_book(tick_level, order_side, order_size, order_type::ORDER_LIMIT, -1, id);
+                    rest_order(id, tick_level, order_side, order_size, order_type::ORDER_LIMIT, -1);
                 } else {
                     std::cout << "Market Order Filled\n"; 
                 }
             }
 
-            void add_to_book(std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price = -1, std::int64_t id_override = -1)
+            std::int64_t available_volume(std::int64_t order_side, std::int64_t limit_price)
+            {
+                // Volume an incoming order on order_side could trade against at limit_price or better:
+                // asks at or below the limit for a buy, bids at or above it for a sell. O(log n) in the tick range.
+                if (order_side == order_side::BID) {
+                    return available_volume<orderbook::matching::bid_side>(limit_price);
+                }
+                return available_volume<orderbook::matching::ask_side>(limit_price);
+            }
+
+            template <typename side>
+            std::int64_t available_volume(std::int64_t limit_price)
+            {
+                using aggressor = orderbook::matching::side_traits<side>;
+                return aggressor::volume_within(orderbook::matching::side_traits<typename aggressor::opposite>::map(this), limit_price);
+            }
+
+            void execute_fill_or_kill(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size)
+            {
+                // Fill or kill orders never rest. Either the whole size is available within the limit and is swept,
+                // or the order is cancelled without touching the book. They cannot be filled during an auction.
+                if (auction_mode || available_volume(order_side, tick_level) < order_size) {
+                    std::cout << "Fill or kill Order: " << id << " Cancelled, Reason: Insufficient Volume\n";
+                    return;
+                }
+                sweep_opposite_side(id, tick_level, order_side, order_size);
+            }
+
+            void execute_immediate_or_cancel(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size)
+            {
+                // Matches what it can at its limit or better and never rests; the remainder is discarded.
+                std::int64_t remaining_size = sweep_opposite_side(id, tick_level, order_side, order_size);
+                if (remaining_size > 0) {
+                    std::cout << "Immediate or cancel Order: " << id << " Remainder: " << remaining_size << " Cancelled\n";
+                }
+            }
+
+            void execute_good_till_date(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_limit_price, std::int64_t expiry_time)
+            {
+                // A limit order that is cancelled once the engine clock reaches expiry_time.
+                if (is_expired_on_arrival(id, expiry_time)) {
+                    return;
+                }
+                std::int64_t remaining_size = sweep_opposite_side(id, tick_level, order_side, order_size);
+                if (remaining_size > 0) {
+                    rest_order(id, tick_level, order_side, remaining_size, order_type::ORDER_GOOD_TILL_DATE, order_limit_price);
+                    schedule_expiry(id, expiry_time);
+                }
+            }
+
+            bool is_expired_on_arrival(std::int64_t id, std::int64_t expiry_time)
+            {
+                if (expiry_time <= get_clock()) {
+                    std::cout << "Good till date Order: " << id << " Cancelled, Reason: Expired On Arrival\n";
+                    return true;
+                }
+                return false;
+            }
+
+            void schedule_expiry(std::int64_t id, std::int64_t expiry_time)
+            {
+                if (!expiries->schedule(id, expiry_time)) {
+                    std::cout << "TIMER POOL EXHAUSTED, Order: " << id << " will not expire.\n";
+                }
+            }
+
+            void execute_iceberg(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t display_size)
+            {
+                // The whole size can trade on arrival, only the part that rests is split into a visible slice and reserve.
+                std::int64_t remaining_size = sweep_opposite_side(id, tick_level, order_side, order_size);
+                if (remaining_size > 0) {
+                    rest_iceberg_order(id, tick_level, order_side, remaining_size, display_size);
+                }
+            }
+
+            void rest_iceberg_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t display_size)
+            {
+                if (order_side == order_side::BID) {
+                    rest_iceberg<orderbook::matching::bid_side>(id, tick_level, order_size, display_size);
+                } else {
+                    rest_iceberg<orderbook::matching::ask_side>(id, tick_level, order_size, display_size);
+                }
+            }
+
+            template <typename side>
+            void rest_iceberg(std::int64_t id, std::int64_t tick_level, std::int64_t order_size, std::int64_t display_size)
+            {
+                using traits = orderbook::matching::side_traits<side>;
+                if (!insert_level<side>(id, tick_level)) {
+                    drop_order("NO FREE PRICE LEVELS.");
+                    return;
+                }
+                std::int64_t sequence = traits::map(this)->add_iceberg_order(id, tick_level, traits::side, order_size, display_size);
+                index->set(id, traits::side, tick_level, sequence);
+            }
+
+            void remove_filled_order(orderbook::maps::order_map* map, std::int64_t tick_level)
+            {
+                // The priority order at tick_level has been fully filled. Icebergs with reserve left are replenished,
+                // only levels flagged as holding icebergs look at the order at all.
+                if (map->has_icebergs(tick_level) && map->get_priority_order(tick_level)->get_reserve() > 0) {
+                    remove_filled_order(map, tick_level, map->get_queue(tick_level)->get_tail());
+                } else {
+                    map->remove_priority_order(tick_level);
+                }
+            }
+
+            void remove_filled_order(orderbook::maps::order_map* map, std::int64_t tick_level, std::int64_t sequence)
+            {
+                // As above, for an order anywhere in the queue.
+                orderbook::order* order = map->get_queue(tick_level)->at(sequence);
+                if (map->has_icebergs(tick_level) && order->get_reserve() > 0) {
+                    std::int64_t id = order->get_order_id();
+                    std::int64_t order_side = order->get_side();
+                    std::cout << "Iceberg Order: " << id << " Replenished, Reserve: " << order->get_reserve() << "\n";
+                    index->set(id, order_side, tick_level, map->replenish_order(tick_level, sequence));
+                } else {
+                    map->remove_order(tick_level, sequence);
+                }
+            }
+
+            template <typename side>
+            void note_top_order(std::int64_t id, std::int64_t tick_level)
+            {
+                // Must be called before the order's level is inserted into the tree.
+                if constexpr (matching_policy::has_top_order) {
+                    using traits = orderbook::matching::side_traits<side>;
+                    orderbook::trees::price_ladder* tree = traits::tree(this);
+                    if (tree->is_empty() || traits::is_better(tick_level, traits::best(tree))) {
+                        traits::top_order(this) = id;
+                    }
+                }
+            }
+
+            template <typename side>
+            bool insert_level(std::int64_t id, std::int64_t tick_level)
+            {
+                // Adds the level of a resting order to its tree. Returns false, leaving the top order as it was, if the
+                // tree's node pool is exhausted.
+                using traits = orderbook::matching::side_traits<side>;
+                std::int64_t top_order = traits::top_order(this);
+                note_top_order<side>(id, tick_level);
+                if (!traits::tree(this)->insert(tick_level)) {
+                    traits::top_order(this) = top_order;
+                    return false;
+                }
+                return true;
+            }
+
+            void rest_order(std::int64_t id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price)
+            {
+                if (order_side == order_side::BID) {
+                    rest<orderbook::matching::bid_side>(id, tick_level, order_size, order_type, order_limit_price);
+                } else {
+                    rest<orderbook::matching::ask_side>(id, tick_level, order_size, order_type, order_limit_price);
+                }
+            }
+
+            template <typename side>
+            void rest(std::int64_t id, std::int64_t tick_level, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price)
+            {
+                using traits = orderbook::matching::side_traits<side>;
+                if (!insert_level<side>(id, tick_level)) {
+                    drop_order("NO FREE PRICE LEVELS.");
+                    return;
+                }
+                std::int64_t sequence = traits::map(this)->add_order(id, tick_level, traits::side, order_size, order_type, order_limit_price);
+                index->set(id, traits::side, tick_level, sequence);
+            }
+
+            bool cancel_order(std::int64_t id)
+            {
+                // Returns false if the order is not resting in the book (unknown, already filled or cancelled).
+                const orderbook::maps::order_location* location = index->get(id);
+                if (location == nullptr) {
+                    return false;
+                }
+                std::int64_t tick_level = location->tick_level;
+                if (location->order_side == order_side::BID) {
+                    if (!bid_map->cancel_order(id, tick_level, location->sequence)) return false;
+                    remove_empty_bid_level(tick_level);
+                } else {
+                    if (!ask_map->cancel_order(id, tick_level, location->sequence)) return false;
+                    remove_empty_ask_level(tick_level);
+                }
+                std::cout << "Order: " << id << " Cancelled\n";
+                flush_events();
+                return true;
+            }
+
+            std::int64_t cancel_all(std::int64_t order_side)
+            {
+                // Kill switch for one side of the book. Returns the number of orders cancelled.
+                return cancel_range(order_side, 0, n_tick_levels - 1);
+            }
+
+            std::int64_t cancel_range(std::int64_t order_side, std::int64_t min_tick_level, std::int64_t max_tick_level)
+            {
+                // Cancels every resting order on order_side from min_tick_level to max_tick_level inclusive, and the
+                // side's untriggered stops with trigger prices in that range, so none can re-enter the book later.
+                // Each live level is reset in one step rather than cancelled order by order.
+                if (order_side == order_side::BID) {
+                    return cancel_levels<orderbook::matching::bid_side>(min_tick_level, max_tick_level, -1);
+                }
+                return cancel_levels<orderbook::matching::ask_side>(min_tick_level, max_tick_level, -1);
+            }
+
+            std::int64_t cancel_owner(std::int64_t owner)
+            {
+                // Cancels every resting or stop order submitted with owner, on both sides. Returns the number cancelled.
+                if (owner < 0) return 0;
+                return cancel_levels<orderbook::matching::bid_side>(0, n_tick_levels - 1, owner) +
+                    cancel_levels<orderbook::matching::ask_side>(0, n_tick_levels - 1, owner);
+            }
+
+            template <typename side>
+            std::int64_t cancel_levels(std::int64_t min_tick_level, std::int64_t max_tick_level, std::int64_t owner)
+            {
+                // Walks only the live levels in range using the price index, then publishes one mass_cancel_event.
+                using traits = orderbook::matching::side_traits<side>;
+                orderbook::trees::price_ladder* tree = traits::tree(this);
+                orderbook::maps::order_map* map = traits::map(this);
+                orderbook::maps::stop_map* stops = (traits::side == order_side::BID) ? bid_stops : ask_stops;
+                orderbook::queues::batch_fill cancelled = {0, 0};
+                auto is_owned = [&](orderbook::order* order) {
+                    return index->get_owner(order->get_order_id()) == owner;
+                };
+                cancelled.orders += (owner < 0) ? stops->cancel_range(min_tick_level, max_tick_level) :
+                    stops->cancel_orders_if(min_tick_level, max_tick_level, is_owned);
+                for (std::int64_t tick_level = tree->find_next_level(min_tick_level); tick_level != -1 && tick_level <= max_tick_level;
+                     tick_level = tree->find_next_level(tick_level + 1)) {
+                    orderbook::queues::batch_fill level = (owner < 0) ? map->clear_level(tick_level) : map->cancel_orders_if(tick_level, is_owned);
+                    cancelled.orders += level.orders;
+                    cancelled.volume += level.volume;
+                    remove_empty_level<side>(tick_level);
+                }
+                mass_cancels->push({traits::side, min_tick_level, max_tick_level, owner, cancelled.orders, cancelled.volume});
+                flush_events();
+                return cancelled.orders;
+            }
+
+            orderbook::queues::queue_position queue_position(std::int64_t id)
+            {
+                // Live orders and volume ahead of a resting order at its level, {-1, -1} if it is not resting.
+                const orderbook::maps::order_location* location = index->get(id);
+                if (location == nullptr || location->tick_level < 0) {
+                    return {-1, -1};
+                }
+                orderbook::maps::order_map* map = (location->order_side == order_side::BID) ? bid_map : ask_map;
+                return map->get_queue_position(id, location->tick_level, location->sequence);
+            }
+
+            bool modify_order(std::int64_t id, std::int64_t new_size, std::int64_t new_price)
+            {
+                // Cancel/replace in one step. Reducing the size at the same price keeps queue position; a new price or
+                // a larger size moves the order to the back of the new level under the same id, matching first if it
+                // now crosses. Returns false if the order is not resting or the new price is out of bounds.
+                const orderbook::maps::order_location* location = index->get(id);
+                if (location == nullptr || new_price < 0 || new_price >= n_tick_levels) {
+                    return false;
+                }
+                std::int64_t side = location->order_side;
+                std::int64_t tick_level = location->tick_level;
+                std::int64_t sequence = location->sequence;
+                orderbook::maps::order_map* map = (side == order_side::BID) ? bid_map : ask_map;
+                orderbook::order* order = map->get_queue(tick_level)->find(sequence, id);
+                if (order == nullptr) {
+                    return false;
+                }
+                if (new_size <= 0) {
+                    return cancel_order(id);
+                }
+                std::cout << "Order: " << id << " Modified, Size: " << new_size << " Price: " << new_price << "\n";
+                std::int64_t current_size = order->get_size() + order->get_reserve();
+                if (new_price == tick_level && new_size <= current_size) {
+                    map->reduce_order(tick_level, sequence, current_size - new_size);
+                    flush_events();
+                    return true;
+                }
+
+                std::int64_t type = order->get_type();
+                std::int64_t limit_price = order->get_limit_price();
+                std::int64_t display_size = order->get_display_size();
+                map->cancel_order(id, tick_level, sequence);
+                if (type == order_type::ORDER_ICEBERG) {
+                    execute_iceberg(id, new_price, side, new_size, display_size);
+                } else {
+                    std::int64_t remaining_size = sweep_opposite_side(id, new_price, side, new_size);
+                    if (remaining_size > 0) {
+                        rest_order(id, new_price, side, remaining_size, type, limit_price);
+                    }
+                }
+                // Checked after re-resting, so a size increase at the same price never removes and re-inserts the level.
+                if (side == order_side::BID) {
+                    remove_empty_bid_level(tick_level);
+                } else {
+                    remove_empty_ask_level(tick_level);
+                }
+                trigger_stop_orders();
+                flush_events();
+                return true;
+            }
+
+            void advance_clock(std::int64_t now)
             {
-                if(tick_level >= n_tick_levels)
+                // Advances the engine clock, cancelling every good till date order whose expiry has been reached.
+                // Filled orders leave their timers behind, the index check in cancel_order makes those no-ops.
+                expiries->advance(now, [this](std::int64_t expired_id) {
+                    cancel_order(expired_id);
+                });
+            }
+
+            std::int64_t get_clock()
+            {
+                return expiries->get_time();
+            }
+
+            void add_to_book(std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price = -1, std::int64_t id_override = -1, std::int64_t expiry_time = -1, std::int64_t display_size = -1, std::int64_t owner = -1)
+            {
+                if(tick_level < 0 || tick_level >= n_tick_levels)
                 {
-                    std::cout << "TICK LEVEL IS OUT OF BOUNDS OF AVAILABLE LEVELS.\n";
-                    std::cout << "-> dropping order.\n";
+                    drop_order("TICK LEVEL IS OUT OF BOUNDS OF AVAILABLE LEVELS.");
                     return;
                 }
                 std::int64_t order_id = (id_override == -1) ? id++ : id_override;
+                if (owner >= 0) {
+                    index->set_owner(order_id, owner);
+                }
 
                 print();
+                dispatch_order(order_id, tick_level, order_side, order_size, order_type, order_limit_price, expiry_time, display_size);
+                trigger_stop_orders();
+                flush_events(); // one batch of fill events per incoming order.
+                print();
+            }
+
+            void add_orders(const orderbook::command* commands, std::int64_t n_commands)
+            {
+                // Applies a batch of commands with deferred matching. Limit and good till date orders rest without
+                // sweeping, so the book may cross inside the batch; it is uncrossed at COMMAND_MATCH entries, before any
+                // command that has to trade against an uncrossed book (other order types, modifies), and at the end.
+                // Stops are checked and fill events flushed once per uncross instead of once per order.
+                bool crossed = false;
+                for (std::int64_t i = 0; i < n_commands; i++) {
+                    const orderbook::command& c = commands[i];
+                    bool is_deferred_add = c.action == command_action::COMMAND_ADD &&
+                        (c.order_type == order_type::ORDER_LIMIT || c.order_type == order_type::ORDER_GOOD_TILL_DATE);
+                    if (crossed && !is_deferred_add && c.action != command_action::COMMAND_CANCEL) {
+                        uncross_batch();
+                        crossed = false;
+                    }
+                    if (c.action == command_action::COMMAND_ADD) {
+                        if (c.tick_level < 0 || c.tick_level >= n_tick_levels) {
+                            drop_order("TICK LEVEL IS OUT OF BOUNDS OF AVAILABLE LEVELS.");
+                            continue;
+                        }
+                        std::int64_t order_id = id++;
+                        if (c.owner >= 0) {
+                            index->set_owner(order_id, c.owner);
+                        }
+                        if (is_deferred_add) {
+                            bool is_good_till_date = c.order_type == order_type::ORDER_GOOD_TILL_DATE;
+                            if (is_good_till_date && is_expired_on_arrival(order_id, c.expiry_time)) {
+                                continue;
+                            }
+                            rest_order(order_id, c.tick_level, c.order_side, c.order_size, c.order_type, c.order_limit_price);
+                            if (is_good_till_date) {
+                                schedule_expiry(order_id, c.expiry_time);
+                            }
+                            crossed = true;
+                        } else {
+                            dispatch_order(order_id, c.tick_level, c.order_side, c.order_size, c.order_type, c.order_limit_price, c.expiry_time, c.display_size);
+                        }
+                    } else if (c.action == command_action::COMMAND_CANCEL) {
+                        cancel_order(c.order_id);
+                    } else if (c.action == command_action::COMMAND_MODIFY) {
+                        modify_order(c.order_id, c.order_size, c.tick_level);
+                    }
+                }
+                uncross_batch();
+            }
+
+            bool load_snapshot(const orderbook::command* commands, std::int64_t n_commands)
+            {
+                // Loads resting limit orders into an empty book, e.g. from a snapshot. Commands must be COMMAND_ADD
+                // limit orders grouped by side and sorted by tick level, in queue order within a level. Each level is
+                // filled in one step and each side's price index is built balanced in one pass, O(n) overall instead
+                // of one tree insert per order. Returns false, leaving the book untouched, for anything else, including
+                // a snapshot that would leave the book crossed.
+                if (!bid_tree->is_empty() || !ask_tree->is_empty()) {
+                    return false;
+                }
+                std::int64_t side_changes = 0;
+                std::int64_t best_bid = -1;
+                std::int64_t best_ask = n_tick_levels;
+                for (std::int64_t i = 0; i < n_commands; i++) {
+                    const orderbook::command& c = commands[i];
+                    bool is_valid = c.action == command_action::COMMAND_ADD && c.order_type == order_type::ORDER_LIMIT &&
+                        c.order_size > 0 && c.tick_level >= 0 && c.tick_level < n_tick_levels &&
+                        (c.order_side == order_side::BID || c.order_side == order_side::ASK);
+                    if (i > 0 && c.order_side != commands[i - 1].order_side) {
+                        side_changes++;
+                    }
+                    bool is_sorted = i == 0 || c.order_side != commands[i - 1].order_side || c.tick_level >= commands[i - 1].tick_level;
+                    if (!is_valid || !is_sorted || side_changes > 1) {
+                        return false;
+                    }
+                    if (c.order_side == order_side::BID) {
+                        best_bid = std::max(best_bid, c.tick_level);
+                    } else {
+                        best_ask = std::min(best_ask, c.tick_level);
+                    }
+                }
+                if (best_bid >= best_ask) {
+                    return false;
+                }
+                std::int64_t* tick_levels = static_cast<std::int64_t*>(std::malloc((n_tick_levels + 1) * sizeof(std::int64_t)));
+                std::int64_t i = 0;
+                while (i < n_commands) {
+                    std::int64_t side_end = i;
+                    while (side_end < n_commands && commands[side_end].order_side == commands[i].order_side) side_end++;
+                    if (commands[i].order_side == order_side::BID) {
+                        load_side<orderbook::matching::bid_side>(commands + i, side_end - i, tick_levels);
+                    } else {
+                        load_side<orderbook::matching::ask_side>(commands + i, side_end - i, tick_levels);
+                    }
+                    i = side_end;
+                }
+                std::free(tick_levels);
+                flush_events();
+                return true;
+            }
+
+            template <typename side>
+            void load_side(const orderbook::command* commands, std::int64_t n_commands, std::int64_t* tick_levels)
+            {
+                using traits = orderbook::matching::side_traits<side>;
+                orderbook::maps::order_map* map = traits::map(this);
+                std::int64_t n_levels = 0;
+                for (std::int64_t first = 0; first < n_commands;) {
+                    std::int64_t tick_level = commands[first].tick_level;
+                    std::int64_t last = first;
+                    while (last < n_commands && commands[last].tick_level == tick_level) last++;
+                    std::int64_t first_id = id;
+                    std::int64_t sequence = map->add_orders(tick_level, last - first, [&](std::int64_t k, orderbook::order* order) {
+                        const orderbook::command& c = commands[first + k];
+                        order->set_order_attributes(first_id + k, c.order_size, traits::side, c.order_type, c.order_limit_price);
+                    });
+                    for (std::int64_t k = 0; k < last - first; k++) {
+                        if (commands[first + k].owner >= 0) {
+                            index->set_owner(id, commands[first + k].owner);
+                        }
+                        index->set(id++, traits::side, tick_level, sequence + k);
+                    }
+                    tick_levels[n_levels++] = tick_level;
+                    first = last;
+                }
+                traits::tree(this)->bulk_load(tick_levels, n_levels);
+                if constexpr (matching_policy::has_top_order) {
+                    // The first order at the best level is treated as having set it.
+                    if (n_levels > 0) {
+                        traits::top_order(this) = map->get_priority_order(traits::best(traits::tree(this)))->get_order_id();
+                    }
+                }
+            }
+
+            void uncross_batch()
+            {
+                match_crossed_orders();
+                trigger_stop_orders();
+                flush_events();
+            }
+
+            void drop_order(const char* reason)
+            {
+                std::cout << reason << "\n";
+                std::cout << "-> dropping order.\n";
+                dropped_orders.increment();
+            }
+
+            void dispatch_order(std::int64_t order_id, std::int64_t tick_level, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price, std::int64_t expiry_time, std::int64_t display_size)
+            {
                 if(order_type == order_type::ORDER_MARKET) { // market
                     execute_market_order(order_id, tick_level, order_side, order_size, order_type);
+                } else if(order_type == order_type::ORDER_LIMIT) {
+                    // A marketable limit order matches against the opposite side on arrival and only its remainder rests,
+                    // so the book is never left crossed.
+                    std::int64_t remaining_size = sweep_opposite_side(order_id, tick_level, order_side, order_size);
+                    if (remaining_size > 0) {
+                        rest_order(order_id, tick_level, order_side, remaining_size, order_type, order_limit_price);
+                    }
+                } else if(order_type == order_type::ORDER_FILL_OR_KILL) {
+                    execute_fill_or_kill(order_id, tick_level, order_side, order_size);
+                } else if(order_type == order_type::ORDER_IMMEDIATE_OR_CANCEL) {
+                    execute_immediate_or_cancel(order_id, tick_level, order_side, order_size);
+                } else if(order_type == order_type::ORDER_GOOD_TILL_DATE) {
+                    execute_good_till_date(order_id, tick_level, order_side, order_size, order_limit_price, expiry_time);
+                } else if(order_type == order_type::ORDER_ICEBERG) {
+                    // Without a display size the whole order is visible.
+                    execute_iceberg(order_id, tick_level, order_side, order_size, (display_size > 0) ? display_size : order_size);
+                } else if(order_type == order_type::ORDER_STOP_LIMIT) {
+                    // Stops wait in their own book keyed by trigger price, so they never add to visible depth.
+                    (order_side == order_side::BID ? bid_stops : ask_stops)->add_order(order_id, tick_level, order_size, order_limit_price);
                 } else {
-                    if(order_side == 1) {
-                        // bid
-                        bid_tree->insert(tick_level);
-                        bid_map->add_order(order_id, tick_level, order_side, order_size, order_type, order_limit_price);
-                    } else {
-                        // ask
-                        ask_tree->insert(tick_level);
-                        ask_map->add_order(order_id, tick_level, order_side, order_size, order_type, order_limit_price);
+                    rest_order(order_id, tick_level, order_side, order_size, order_type, order_limit_price);
+                }
+            }
+
+            void trigger_stop_orders()
+            {
+                // Orders released here can trade and move the last trade price again. They re-enter add_to_book,
+                // so only the outermost call loops, until no stop on either side is in range of the last trade.
+                if (triggering_stops) return;
+                triggering_stops = true;
+                while (true) {
+                    orderbook::maps::stop_map* stops = bid_stops;
+                    std::int64_t trigger_price = bid_stops->get_triggered_level(last_trade_price);
+                    if (trigger_price == -1) {
+                        stops = ask_stops;
+                        trigger_price = ask_stops->get_triggered_level(last_trade_price);
                     }
+                    if (trigger_price == -1) break;
+
+                    orderbook::order* stop = stops->remove_priority_order(trigger_price);
+                    std::int64_t stop_id = stop->get_order_id();
+                    std::int64_t stop_side = stop->get_side();
+                    std::int64_t stop_size = stop->get_size();
+                    std::int64_t limit_price = (stop->get_limit_price() < 0) ? trigger_price : stop->get_limit_price();
+                    std::cout << "Stop order triggered, ID: " << stop_id << " Last Trade Price: " << last_trade_price << "\n";
+                    add_to_book(limit_price, stop_side, stop_size, order_type::ORDER_LIMIT, -1, stop_id);
                 }
-                print();
+                triggering_stops = false;
             }
 
             bool bids_and_asks_exist() {
@@ -148,48 +842,28 @@ namespace orderbook
             }
 
             void remove_empty_bid_level(std::int64_t bid_level) {
-                if (bid_map->is_empty(bid_level)) bid_tree->remove(bid_level);
+                remove_empty_level<orderbook::matching::bid_side>(bid_level);
             }
 
             void remove_empty_ask_level(std::int64_t ask_level) {
-                if (ask_map->is_empty(ask_level)) ask_tree->remove(ask_level);
+                remove_empty_level<orderbook::matching::ask_side>(ask_level);
             }
 
-            bool handle_fill_or_kill(orderbook::order* order, std::int64_t price_level, int total_volume_available) {
-                if (order->get_type() == 3 && total_volume_available < order->get_size()) {
-                    // Order is bigger than total volume at best price level on other side.
-                    std::cout << "Fill or kill Order: " << order->get_order_id() << " Cancelled, Reason: Insufficient Volume\n";
-                    if(order->get_side() == 1) {
-                        // bid
-                        bid_map->remove_priority_order(price_level);
-                        remove_empty_bid_level(price_level);
-                    } else {
-                        // ask
-                        ask_map->remove_priority_order(price_level);
-                        remove_empty_ask_level(price_level);
-                    }
-                    return true;
-                }
-                return false;
+            template <typename side>
+            void remove_empty_level(std::int64_t tick_level) {
+                using traits = orderbook::matching::side_traits<side>;
+                if (traits::map(this)->is_empty(tick_level)) traits::tree(this)->remove(tick_level);
             }
 
-            bool handle_stop_limit(orderbook::order* order, std::int64_t price_level) {
-                if (order->get_type() == 2) { // stop limit order detected, move to specified limit price level on book.
-                    std::cout << "Limit order Hit, ID: " << order->get_order_id() << "\n";
-                    if(order->get_side() == 1) {
-                        // bid
-                        bid_map->remove_priority_order(price_level);
-                        remove_empty_bid_level(price_level);
-                    } else {
-                        // ask
-                        ask_map->remove_priority_order(price_level);
-                        remove_empty_ask_level(price_level);
-                    }
-                    // Add limit order at limit price to book when stop hit.
-                    add_to_book(order->get_limit_price(), order->get_side(), order->get_size(), 1, -1, order->get_order_id());
-                    return true;
+            void print_volume(char symbol, std::int64_t volume)
+            {
+                // Written in fixed-size blocks from the stack so printing never allocates on the matching thread.
+                char block[64];
+                std::fill(block, block + 64, symbol);
+                for (; volume > 0; volume -= 64)
+                {
+                    std::cout.write(block, std::min<std::int64_t>(volume, 64));
                 }
-                return false;
             }
 
             void print()
@@ -204,9 +878,10 @@ namespace orderbook
                         std::cout << "=>\n";
                         found_market_price = true;
                     }
-                    std::string ask_volume(ask_vol, 'A');
-                    std::string bid_volume(bid_vol, 'B');
-                    std::cout << tick_level << " | " << bid_volume << ask_volume << "\n";
+                    std::cout << tick_level << " | ";
+                    print_volume('B', bid_vol);
+                    print_volume('A', ask_vol);
+                    std::cout << "\n";
                 }
                 if(!found_market_price) {
                     std::cout << "-<\n";
@@ -216,51 +891,166 @@ namespace orderbook
 
             void match_orders()
             {
-                while (can_match_orders()) {
-
-                    print();
+                print();
+                match_crossed_orders();
+                print();
+                std::cout << "* Finished Matching *" << "\n";
+                trigger_stop_orders();
+                flush_events();
+            }
 
+            void match_crossed_orders()
+            {
+                // Matches resting orders while the best bid is at or above the best ask. During an auction orders
+                // accumulate crossed until uncross().
+                if (auction_mode) return;
+                while (can_match_orders()) {
                     std::int64_t best_bid_price = bid_tree->get_max_value();
                     std::int64_t best_ask_price = ask_tree->get_min_value();
-                    orderbook::order* bid = bid_map->get_priority_order(best_bid_price);
-                    orderbook::order* ask = ask_map->get_priority_order(best_ask_price);
-                    std::int64_t bid_id = bid->get_order_id();
-                    std::int64_t ask_id = ask->get_order_id();
+                    std::int64_t bid_id = bid_map->get_priority_order(best_bid_price)->get_order_id();
+                    std::int64_t ask_id = ask_map->get_priority_order(best_ask_price)->get_order_id();
                     std::int64_t execution_price = get_resting_order_execution_price(bid_id, best_bid_price, ask_id, best_ask_price);
-  
-                    if (handle_stop_limit(bid, best_bid_price) || handle_stop_limit(ask, best_ask_price)) continue;
-                    if (handle_fill_or_kill(bid, best_ask_price, ask_map->get_total_volume_at_tick_level(best_ask_price))) continue;
-                    if (handle_fill_or_kill(ask, best_bid_price, bid_map->get_total_volume_at_tick_level(best_bid_price))) continue;
-
-                    if (bid->get_size() == ask->get_size()) {
-                        // Both Bid and Ask match in size and can be removed.
-                        bid_map->remove_priority_order(best_bid_price);
-                        ask_map->remove_priority_order(best_ask_price);
-                        std::cout << "Bid Order: " << bid_id << " matched with Ask Order: " << ask_id << " at Price: " << execution_price << "\n";
-                    } else if (bid->get_size() > ask->get_size()) {
-                        // Ask filled fully, Bid partial fill.
-                        bid_map->partial_fill_priority(best_bid_price, ask->get_size()); // <<< NEEDS TO BE HANDLED
-                        ask_map->remove_priority_order(best_ask_price); 
-                        std::cout << "Bid Order Partial Fill: " << bid_id << " matched with Ask Order: " << ask_id << " at Price: " << execution_price << "\n";
-                    } else {
-                        // Bid filled fully, Ask partial fill.
-                        ask_map->partial_fill_priority(best_ask_price, bid->get_size()); // <<< NEEDS TO BE HANDLED
-                        bid_map->remove_priority_order(best_bid_price);
-                        std::cout << "Bid Order: " << bid_id << " matched with Ask Order Partial Fill: " << ask_id << " at Price: " << execution_price << "\n";
+                    // The order that arrived later is the aggressor.
+                    match_best_orders(best_bid_price, best_ask_price, execution_price, std::max(bid_id, ask_id), std::min(bid_id, ask_id));
+                }
+            }
+
+            void set_auction_mode(bool enabled)
+            {
+                auction_mode = enabled;
+            }
+
+            bool is_auction_mode()
+            {
+                return auction_mode;
+            }
+
+            std::int64_t uncross()
+            {
+                // Executes the crossed part of the book at the single price that maximises executed volume. Ties go to
+                // the smallest imbalance between demand and supply, then to the price nearest the last trade, then to
+                // the lowest price. Returns the equilibrium price, or -1 if the book is not crossed.
+                if (!can_match_orders()) {
+                    return -1;
+                }
+                std::int64_t lo = ask_tree->get_min_value();
+                std::int64_t hi = bid_tree->get_max_value();
+                std::int64_t n_levels = hi - lo + 1;
+
+                // Gather level volumes into flat arrays once, so the curves and the selection pass run over
+                // contiguous memory and the reduction vectorizes.
+                for (std::int64_t i = 0; i < n_levels; i++) {
+                    auction_supply[i] = ask_map->get_total_volume_at_tick_level(lo + i);
+                    auction_demand[i] = bid_map->get_total_volume_at_tick_level(lo + i);
+                }
+                for (std::int64_t i = 1; i < n_levels; i++) {
+                    auction_supply[i] += auction_supply[i - 1];
+                }
+                for (std::int64_t i = n_levels - 2; i >= 0; i--) {
+                    auction_demand[i] += auction_demand[i + 1];
+                }
+                std::int64_t max_volume = 0;
+                for (std::int64_t i = 0; i < n_levels; i++) {
+                    max_volume = std::max(max_volume, std::min(auction_demand[i], auction_supply[i]));
+                }
+
+                std::int64_t reference = (last_trade_price < 0) ? lo : last_trade_price;
+                std::int64_t price = -1;
+                std::int64_t best_imbalance = 0;
+                for (std::int64_t i = 0; i < n_levels; i++) {
+                    if (std::min(auction_demand[i], auction_supply[i]) != max_volume) continue;
+                    std::int64_t imbalance = std::abs(auction_demand[i] - auction_supply[i]);
+                    bool is_better = price == -1 || imbalance < best_imbalance ||
+                        (imbalance == best_imbalance && std::abs(lo + i - reference) < std::abs(price - reference));
+                    if (is_better) {
+                        price = lo + i;
+                        best_imbalance = imbalance;
                     }
-                    remove_empty_tick_levels(best_bid_price, best_ask_price);
+                }
 
-                    print();
+                std::cout << "UNCROSS: Price: " << price << " Volume: " << max_volume << "\n";
+                // Bids at or above the price and asks at or below it trade in price-time priority, all at the price.
+                while (can_match_orders() && bid_tree->get_max_value() >= price && ask_tree->get_min_value() <= price) {
+                    std::int64_t best_bid_price = bid_tree->get_max_value();
+                    std::int64_t best_ask_price = ask_tree->get_min_value();
+                    std::int64_t bid_id = bid_map->get_priority_order(best_bid_price)->get_order_id();
+                    std::int64_t ask_id = ask_map->get_priority_order(best_ask_price)->get_order_id();
+                    match_best_orders(best_bid_price, best_ask_price, price, bid_id, ask_id);
                 }
-                std::cout << "* Finished Matching *" << "\n";
+                trigger_stop_orders();
+                flush_events();
+                return price;
             }
 
-            ~book()
+            void match_best_orders(std::int64_t best_bid_price, std::int64_t best_ask_price, std::int64_t execution_price, std::int64_t aggressor_id, std::int64_t resting_id)
             {
+                // Fills the priority bid against the priority ask at execution_price.
+                orderbook::order* bid = bid_map->get_priority_order(best_bid_price);
+                orderbook::order* ask = ask_map->get_priority_order(best_ask_price);
+                last_trade_price = execution_price;
+                std::int64_t fill_size = std::min(bid->get_size(), ask->get_size());
+                record_fill(aggressor_id, resting_id, execution_price, fill_size);
+
+                if (bid->get_size() == ask->get_size()) {
+                    // Both Bid and Ask match in size and can be removed.
+                    remove_filled_order(bid_map, best_bid_price);
+                    remove_filled_order(ask_map, best_ask_price);
+                } else if (bid->get_size() > ask->get_size()) {
+                    // Ask filled fully, Bid partial fill.
+                    bid_map->partial_fill_priority(best_bid_price, ask->get_size()); // <<< NEEDS TO BE HANDLED
+                    remove_filled_order(ask_map, best_ask_price);
+                } else {
+                    // Bid filled fully, Ask partial fill.
+                    ask_map->partial_fill_priority(best_ask_price, bid->get_size()); // <<< NEEDS TO BE HANDLED
+                    remove_filled_order(bid_map, best_bid_price);
+                }
+                remove_empty_tick_levels(best_bid_price, best_ask_price);
+            }
+
+            book_stats get_stats()
+            {
+                // Safe to call from any thread, every field is a relaxed read of a single-writer counter.
+                book_stats stats;
+                stats.bid_levels = bid_tree->get_n_live_levels();
+                stats.ask_levels = ask_tree->get_n_live_levels();
+                stats.bid_nodes_in_use = bid_tree->get_node_pool()->get_in_use();
+                stats.bid_node_capacity = bid_tree->get_node_pool()->get_capacity();
+                stats.ask_nodes_in_use = ask_tree->get_node_pool()->get_in_use();
+                stats.ask_node_capacity = ask_tree->get_node_pool()->get_capacity();
+                stats.bid_resting_orders = bid_map->get_resting_orders();
+                stats.ask_resting_orders = ask_map->get_resting_orders();
+                stats.bid_stop_orders = bid_stops->get_resting_orders();
+                stats.ask_stop_orders = ask_stops->get_resting_orders();
+                stats.queue_growths = bid_map->get_queue_growths() + ask_map->get_queue_growths();
+                stats.queue_growths_on_matching_thread = bid_map->get_queue_growths_on_matching_thread() + ask_map->get_queue_growths_on_matching_thread();
+                stats.dropped_orders = dropped_orders.get();
+                stats.pending_expiries = expiries->get_pending();
+                return stats;
+            }
+
+            ~basic_book()
+            {
+                delete grower; // joins the grower thread before the pools it serves are destroyed.
                 delete bid_tree;
                 delete ask_tree;
                 delete bid_map;
                 delete ask_map;
+                delete bid_stops;
+                delete ask_stops;
+                delete index;
+                delete expiries;
+                delete fills;
+                delete mass_cancels;
+                delete level_events;
+                std::free(auction_demand);
+                std::free(auction_supply);
             }
     };
+
+    class book : public basic_book<orderbook::matching::price_time>
+    {
+        // The default price-time book.
+        public:
+            using basic_book::basic_book;
+    };
 }
@@ -0,0 +1,225 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "orderbook/bitmaps/mempool_bitmap.h"
+#include "orderbook/pools/pool_grower.h"
+#include "orderbook/telemetry/counter.h"
+
+namespace orderbook::pools {
+
+    template <typename T>
+    class object_pool : public orderbook::pools::growable_pool
+    {
+        // The pool grows in whole chunks of the initial size. Objects never move, so pointers stay valid. The chunk
+        // table starts with room for INITIAL_CHUNKS and doubles when full, so the pool is bounded only by memory.
+        std::int64_t static constexpr INITIAL_CHUNKS = 32;
+
+        public:
+            // A handle packs the chunk into the high bits and the slot within it into the low bits, so resolving
+            // one is a shift, a mask and an add. Chunks hold at most 2^HANDLE_SHIFT objects, and only the first
+            // MAX_HANDLE_CHUNKS chunks can be addressed by handle.
+            std::int64_t static constexpr HANDLE_SHIFT = 26;
+            std::int64_t static constexpr MAX_HANDLE_CHUNKS = 1LL << (32 - HANDLE_SHIFT);
+            std::uint32_t static constexpr HANDLE_MASK = (1u << HANDLE_SHIFT) - 1;
+            std::uint32_t static constexpr NO_HANDLE = ~0u;
+
+        private:
+            T** chunks;
+            std::int64_t max_chunks; // size of the chunk table.
+            T prototype;
+            orderbook::bitmaps::mempool_bitmap* mp_bm;
+            orderbook::pools::pool_grower* grower;
+            std::atomic<T*> spare; // next chunk, prepared by the grower thread.
+            std::int64_t chunk_size;
+            std::int64_t n_chunks;
+            std::int64_t high_water_mark;
+            orderbook::telemetry::counter n_in_use;
+            orderbook::telemetry::counter capacity;
+            bool growth_requested;
+
+            void request_growth()
+            {
+                // Ask for the next chunk ahead of time so the matching thread never has to allocate it.
+                if (growth_requested || grower == nullptr) return;
+                growth_requested = grower->request_chunk(this);
+            }
+
+            void grow_table()
+            {
+                // Doubles the chunk table and the free slot bitmap. Chunks stay where they are, only the table of
+                // pointers to them and the bitmap are copied, which happens once per doubling of the pool.
+                std::int64_t new_max_chunks = max_chunks * 2;
+                chunks = static_cast<T**>(std::realloc(chunks, new_max_chunks * sizeof(T*)));
+                orderbook::bitmaps::mempool_bitmap* grown = new orderbook::bitmaps::mempool_bitmap{chunk_size * new_max_chunks, false};
+                for (std::int64_t i = 0; i < n_chunks * chunk_size; i++)
+                {
+                    if (mp_bm->is_free(i)) grown->release(i);
+                }
+                delete mp_bm;
+                mp_bm = grown;
+                max_chunks = new_max_chunks;
+            }
+
+            bool grow(std::int64_t chunk_limit)
+            {
+                if (n_chunks >= chunk_limit)
+                {
+                    return false;
+                }
+                if (n_chunks == max_chunks)
+                {
+                    grow_table();
+                }
+                T* chunk = spare.exchange(nullptr, std::memory_order_acquire);
+                if (chunk == nullptr)
+                {
+                    // The grower has not caught up (or there is none), allocate on this thread rather than drop state.
+                    chunk = orderbook::pools::allocate_chunk<T>(chunk_size, prototype);
+                }
+                chunks[n_chunks] = chunk;
+                mp_bm->release_range(n_chunks * chunk_size, (n_chunks + 1) * chunk_size);
+                n_chunks++;
+                capacity.set(n_chunks * chunk_size);
+                high_water_mark = get_capacity() - get_capacity() / 4;
+                growth_requested = false;
+                return true;
+            }
+
+            std::int64_t aquire_index(std::int64_t chunk_limit)
+            {
+                // Only slots of attached chunks are ever marked free in the bitmap. Returns -1 if every slot is in
+                // use and the pool already has chunk_limit chunks.
+                std::int64_t free_index = mp_bm->aquire();
+                if (free_index < 0)
+                {
+                    if (!grow(chunk_limit))
+                    {
+                        return -1;
+                    }
+                    free_index = mp_bm->aquire();
+                }
+                n_in_use.increment();
+                if (n_in_use.get() >= high_water_mark && n_chunks < chunk_limit)
+                {
+                    request_growth();
+                }
+                return free_index;
+            }
+
+        public:
+            object_pool(std::int64_t n, const T& prototype, orderbook::pools::pool_grower* grower = nullptr) :
+                prototype(prototype), grower(grower), spare(nullptr)
+            {
+                // Eagerly construct every slot from the prototype so acquiring an object never allocates.
+                chunk_size = n;
+                n_chunks = 0;
+                growth_requested = false;
+                max_chunks = INITIAL_CHUNKS;
+                chunks = static_cast<T**>(std::malloc(max_chunks * sizeof(T*)));
+                mp_bm = new orderbook::bitmaps::mempool_bitmap{chunk_size * max_chunks, false};
+                grow(max_chunks);
+            }
+
+            ~object_pool()
+            {
+                for (std::int64_t i = 0; i < n_chunks; i++)
+                {
+                    orderbook::pools::free_chunk<T>(chunks[i], chunk_size);
+                }
+                std::free(chunks);
+                T* chunk = spare.exchange(nullptr);
+                if (chunk != nullptr)
+                {
+                    orderbook::pools::free_chunk<T>(chunk, chunk_size);
+                }
+                delete mp_bm;
+            }
+
+            void prepare_chunk() override
+            {
+                if (spare.load(std::memory_order_acquire) == nullptr)
+                {
+                    spare.store(orderbook::pools::allocate_chunk<T>(chunk_size, prototype), std::memory_order_release);
+                }
+            }
+
+            void reclaim_chunk(void* chunk, std::int64_t n) override
+            {
+                orderbook::pools::free_chunk<T>(static_cast<T*>(chunk), n);
+            }
+
+            T* aquire()
+            {
+                std::int64_t free_index = aquire_index(INT64_MAX);
+                return (free_index < 0) ? nullptr : at(free_index);
+            }
+
+            std::uint32_t aquire_handle()
+            {
+                // As aquire(), returning a 32-bit handle instead of a pointer, or NO_HANDLE when the pool is full and
+                // has grown as far as handles can address.
+                std::int64_t free_index = aquire_index(MAX_HANDLE_CHUNKS);
+                if (free_index < 0)
+                {
+                    return NO_HANDLE;
+                }
+                return static_cast<std::uint32_t>(((free_index / chunk_size) << HANDLE_SHIFT) | (free_index % chunk_size));
+            }
+
+            T* from_handle(std::uint32_t handle)
+            {
+                return chunks[handle >> HANDLE_SHIFT] + (handle & HANDLE_MASK);
+            }
+
+            void release_handle(std::uint32_t handle)
+            {
+                n_in_use.decrement();
+                mp_bm->release((handle >> HANDLE_SHIFT) * chunk_size + (handle & HANDLE_MASK));
+            }
+
+            void release(T* object)
+            {
+                n_in_use.decrement();
+                mp_bm->release(index_of(object));
+            }
+
+            std::int64_t index_of(T* object)
+            {
+                for (std::int64_t c = 0; c < n_chunks; c++)
+                {
+                    if (object >= chunks[c] && object < chunks[c] + chunk_size)
+                    {
+                        return c * chunk_size + (object - chunks[c]);
+                    }
+                }
+                return -1;
+            }
+
+            T* at(std::int64_t index)
+            {
+                return chunks[index / chunk_size] + (index % chunk_size);
+            }
+
+            T* get_mempool()
+            {
+                return chunks[0];
+            }
+
+            std::int64_t get_capacity()
+            {
+                return capacity.get();
+            }
+
+            std::int64_t get_in_use()
+            {
+                return n_in_use.get();
+            }
+
+            std::int64_t get_n_chunks()
+            {
+                return n_chunks;
+            }
+    };
+}
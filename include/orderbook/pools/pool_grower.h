@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace orderbook::pools {
+
+    template <typename T>
+    T* allocate_chunk(std::int64_t n, const T& prototype)
+    {
+        // Constructing every slot touches every page, so the chunk is prefaulted before it is handed over.
+        T* chunk = static_cast<T*>(std::malloc(n * sizeof(T)));
+        for (std::int64_t i = 0; i < n; i++)
+        {
+            new (chunk+i) T{prototype};
+        }
+        return chunk;
+    }
+
+    template <typename T>
+    void free_chunk(T* chunk, std::int64_t n)
+    {
+        for (std::int64_t i = 0; i < n; i++)
+        {
+            (chunk+i)->~T();
+        }
+        std::free(chunk);
+    }
+
+    class growable_pool
+    {
+        public:
+            virtual void prepare_chunk() = 0;
+            virtual void reclaim_chunk(void* chunk, std::int64_t n) = 0;
+            virtual ~growable_pool() = default;
+    };
+
+    class pool_grower
+    {
+        // Requests are only ever issued by the matching thread and consumed by the grower thread (SPSC).
+        std::int64_t static constexpr QUEUE_SIZE = 1024;
+
+        struct growth_task
+        {
+            orderbook::pools::growable_pool* pool;
+            void* retired;
+            std::int64_t retired_size;
+        };
+
+        private:
+            growth_task tasks[QUEUE_SIZE];
+            std::atomic<std::int64_t> head;
+            std::atomic<std::int64_t> tail;
+            std::atomic<bool> stopping;
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::thread worker;
+
+            bool push(growth_task task)
+            {
+                std::int64_t h = head.load(std::memory_order_relaxed);
+                if (h - tail.load(std::memory_order_acquire) == QUEUE_SIZE)
+                {
+                    return false;
+                }
+                tasks[h % QUEUE_SIZE] = task;
+                head.store(h + 1, std::memory_order_release);
+                cv.notify_one(); // never takes the mutex, the worker also wakes on a short timeout.
+                return true;
+            }
+
+            void drain()
+            {
+                std::int64_t t = tail.load(std::memory_order_relaxed);
+                while (t != head.load(std::memory_order_acquire))
+                {
+                    growth_task& task = tasks[t % QUEUE_SIZE];
+                    if (task.retired != nullptr)
+                    {
+                        task.pool->reclaim_chunk(task.retired, task.retired_size);
+                    }
+                    else
+                    {
+                        task.pool->prepare_chunk();
+                    }
+                    t++;
+                    tail.store(t, std::memory_order_release);
+                }
+            }
+
+            void run()
+            {
+                while (!stopping.load(std::memory_order_acquire))
+                {
+                    drain();
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                        return stopping.load(std::memory_order_acquire) || tail.load(std::memory_order_relaxed) != head.load(std::memory_order_acquire);
+                    });
+                }
+                drain();
+            }
+
+        public:
+            pool_grower() : head(0), tail(0), stopping(false)
+            {
+                worker = std::thread([this]() { run(); });
+            }
+
+            ~pool_grower()
+            {
+                stopping.store(true, std::memory_order_release);
+                cv.notify_one();
+                worker.join();
+            }
+
+            std::thread::native_handle_type get_native_handle()
+            {
+                return worker.native_handle();
+            }
+
+            bool request_chunk(orderbook::pools::growable_pool* pool)
+            {
+                return push({pool, nullptr, 0});
+            }
+
+            bool retire_chunk(orderbook::pools::growable_pool* pool, void* chunk, std::int64_t n)
+            {
+                return push({pool, chunk, n});
+            }
+    };
+}
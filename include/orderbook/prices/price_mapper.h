@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace orderbook::prices {
+
+    // Converts between absolute prices (e.g. LOBSTER prices x10000) and the dense tick levels 0..n_tick_levels used
+    // by book. Mappers are literal types, so a venue's tick schedule can be fixed at compile time and conversions
+    // fold to a subtract and a divide. to_tick returns -1 for prices outside the range or off the tick grid.
+
+    class fixed_tick_mapper
+    {
+        private:
+            std::int64_t min_price; // price of tick level 0.
+            std::int64_t tick_size;
+            std::int64_t n_tick_levels;
+
+        public:
+            constexpr fixed_tick_mapper(std::int64_t min_price, std::int64_t tick_size, std::int64_t n_tick_levels) :
+                min_price(min_price), tick_size(tick_size), n_tick_levels(n_tick_levels) {}
+
+            constexpr std::int64_t to_tick(std::int64_t price) const
+            {
+                std::int64_t offset = price - min_price;
+                std::int64_t tick_level = offset / tick_size;
+                bool is_valid = offset >= 0 && offset % tick_size == 0 && tick_level < n_tick_levels;
+                return is_valid ? tick_level : -1;
+            }
+
+            constexpr std::int64_t to_price(std::int64_t tick_level) const
+            {
+                return min_price + tick_level * tick_size;
+            }
+
+            constexpr std::int64_t get_n_tick_levels() const
+            {
+                return n_tick_levels;
+            }
+    };
+
+    struct tick_band
+    {
+        std::int64_t min_price; // the band covers prices from here up to the next band's min_price.
+        std::int64_t tick_size;
+    };
+
+    template <std::size_t N>
+    class tick_table_mapper
+    {
+        // A tick schedule that changes by price band, e.g. 1 below 10.00 and 5 above. Each band's first tick level
+        // is precomputed, so a lookup finds the band and then maps like fixed_tick_mapper. The band is found by
+        // counting the bands that start at or below the price, a fixed number of compares and adds with no
+        // data-dependent branches, which suits schedules of a handful of bands.
+        static_assert(N > 0, "a tick table needs at least one band");
+
+        private:
+            std::int64_t min_prices[N];
+            std::int64_t tick_sizes[N];
+            std::int64_t first_ticks[N]; // tick level of each band's min_price.
+            std::int64_t max_price; // exclusive upper bound of the last band.
+            std::int64_t n_tick_levels;
+
+            constexpr std::size_t band_of_price(std::int64_t price) const
+            {
+                std::size_t n_below = 0;
+                for (std::size_t i = 1; i < N; i++)
+                {
+                    n_below += (min_prices[i] <= price);
+                }
+                return n_below;
+            }
+
+            constexpr std::size_t band_of_tick(std::int64_t tick_level) const
+            {
+                std::size_t n_below = 0;
+                for (std::size_t i = 1; i < N; i++)
+                {
+                    n_below += (first_ticks[i] <= tick_level);
+                }
+                return n_below;
+            }
+
+        public:
+            // Bands must be sorted by min_price, and each band's width a multiple of its tick size.
+            constexpr tick_table_mapper(const tick_band (&bands)[N], std::int64_t max_price) :
+                min_prices(), tick_sizes(), first_ticks(), max_price(max_price), n_tick_levels(0)
+            {
+                for (std::size_t i = 0; i < N; i++)
+                {
+                    min_prices[i] = bands[i].min_price;
+                    tick_sizes[i] = bands[i].tick_size;
+                    first_ticks[i] = n_tick_levels;
+                    std::int64_t band_end = (i + 1 < N) ? bands[i + 1].min_price : max_price;
+                    n_tick_levels += (band_end - bands[i].min_price) / bands[i].tick_size;
+                }
+            }
+
+            constexpr std::int64_t to_tick(std::int64_t price) const
+            {
+                if (price < min_prices[0] || price >= max_price)
+                {
+                    return -1;
+                }
+                std::size_t band = band_of_price(price);
+                std::int64_t offset = price - min_prices[band];
+                if (offset % tick_sizes[band] != 0)
+                {
+                    return -1;
+                }
+                return first_ticks[band] + offset / tick_sizes[band];
+            }
+
+            constexpr std::int64_t to_price(std::int64_t tick_level) const
+            {
+                std::size_t band = band_of_tick(tick_level);
+                return min_prices[band] + (tick_level - first_ticks[band]) * tick_sizes[band];
+            }
+
+            constexpr std::int64_t get_n_tick_levels() const
+            {
+                return n_tick_levels;
+            }
+    };
+}
@@ -1,60 +1,259 @@
+#pragma once
+#include <atomic>
+#include <iostream>
 #include "orderbook/order/order.h"
+#include "orderbook/pools/pool_grower.h"
+#include "orderbook/telemetry/counter.h"
 
 namespace orderbook::queues {
-    class ring_buffer
+    struct batch_fill
     {
+        std::int64_t orders; // live orders filled, cancelled slots passed over are not counted.
+        std::int64_t volume;
+    };
+
+    struct queue_position
+    {
+        std::int64_t orders_ahead;
+        std::int64_t volume_ahead;
+    };
+
+    class ring_buffer : public orderbook::pools::growable_pool
+    {
+        std::int64_t static constexpr SPARE_EMPTY = 0;
+        std::int64_t static constexpr SPARE_PREPARING = 1;
+        std::int64_t static constexpr SPARE_READY = 2;
+
         private:
             orderbook::order* mempool;
             std::int64_t mempool_size;
+            std::int64_t chunk_size;
+            std::int64_t high_water_mark;
             std::int64_t head;
             std::int64_t tail;
             std::int64_t total_volume;
+            std::int64_t enqueued_volume; // running offset, all volume ever queued here.
+            std::int64_t reduced_head; // sorted list of sequences behind the tail that were reduced or cancelled in place.
+            std::int64_t reduced_last; // last sequence on that list, -1 when it is empty.
+            orderbook::pools::pool_grower* grower;
+            std::atomic<std::int64_t> spare_state; // SPARE_EMPTY -> SPARE_PREPARING (grower) -> SPARE_READY -> SPARE_EMPTY (matching).
+            std::atomic<std::int64_t> requested_size;
+            orderbook::order* spare; // next, larger block prepared by the grower thread.
+            std::int64_t spare_size;
+            bool growth_requested;
+            orderbook::telemetry::counter depth_high_water_mark;
+            orderbook::telemetry::counter growths;
+            orderbook::telemetry::counter growths_on_matching_thread;
+
+            void request_growth()
+            {
+                // Ask for the next block ahead of time so a burst never finds the queue full with nothing prepared.
+                if (growth_requested || grower == nullptr) return;
+                requested_size.store(mempool_size + chunk_size, std::memory_order_relaxed);
+                growth_requested = grower->request_chunk(this);
+            }
+
+            void skip_cancelled()
+            {
+                // Keeps the invariant that the order at tail is live, so peek and dequeue never return a cancelled order.
+                while (tail != head && (mempool+(tail%mempool_size))->is_cancelled())
+                {
+                    tail++;
+                }
+                // Reduced orders the tail has passed are no longer ahead of anything.
+                while (reduced_head != -1 && reduced_head < tail)
+                {
+                    orderbook::order* order = mempool+(reduced_head%mempool_size);
+                    reduced_head = order->order_next_reduced;
+                    order->order_next_reduced = orderbook::order::NOT_REDUCED;
+                }
+                if (reduced_head == -1)
+                {
+                    reduced_last = -1;
+                }
+            }
+
+            void note_reduced(std::int64_t sequence)
+            {
+                // Volume leaving from behind the tail is the one thing the running offsets cannot see, so those
+                // orders are listed in sequence order. The tail order is accounted for directly. Batches that walk a
+                // level front to back (owner cancels, pro-rata fills) reduce in sequence order and append in O(1).
+                orderbook::order* order = mempool+(sequence%mempool_size);
+                if (sequence == tail || order->order_next_reduced != orderbook::order::NOT_REDUCED)
+                {
+                    return;
+                }
+                if (reduced_last == -1 || sequence > reduced_last)
+                {
+                    order->order_next_reduced = -1;
+                    if (reduced_last == -1)
+                    {
+                        reduced_head = sequence;
+                    }
+                    else
+                    {
+                        (mempool+(reduced_last%mempool_size))->order_next_reduced = sequence;
+                    }
+                    reduced_last = sequence;
+                    return;
+                }
+                std::int64_t* link = &reduced_head;
+                while (*link != -1 && *link < sequence)
+                {
+                    link = &(mempool+(*link%mempool_size))->order_next_reduced;
+                }
+                order->order_next_reduced = *link;
+                *link = sequence;
+            }
+
+            std::int64_t get_queued_size(std::int64_t sequence)
+            {
+                // Size of the order when it was queued, from the running offsets of it and its successor.
+                std::int64_t next_offset = (sequence + 1 < head) ? (mempool+((sequence + 1)%mempool_size))->order_queue_offset : enqueued_volume;
+                return next_offset - (mempool+(sequence%mempool_size))->order_queue_offset;
+            }
+
+            void grow()
+            {
+                grow_to(mempool_size + chunk_size);
+            }
+
+            void grow_to(std::int64_t new_size)
+            {
+                // Grow in whole chunks. Orders keep their sequence numbers, so a sequence always maps to slot
+                // sequence % mempool_size and locations held by the order index survive growth.
+                orderbook::order* block = nullptr;
+                if (spare_state.load(std::memory_order_acquire) == SPARE_READY)
+                {
+                    block = spare;
+                    if (spare_size != new_size)
+                    {
+                        retire(block, spare_size); // prepared for a capacity we already passed.
+                        block = nullptr;
+                    }
+                    spare_state.store(SPARE_EMPTY, std::memory_order_release);
+                }
+                if (block == nullptr)
+                {
+                    // The grower has not caught up (or there is none), allocate on this thread rather than drop orders.
+                    std::cout << "RING BUFFER FULL, GROWING ON MATCHING THREAD\n";
+                    growths_on_matching_thread.increment();
+                    block = orderbook::pools::allocate_chunk<orderbook::order>(new_size, orderbook::order{-2, 0});
+                }
+                for (std::int64_t sequence = tail; sequence < head; sequence++)
+                {
+                    block[sequence % new_size] = mempool[sequence % mempool_size];
+                }
+                retire(mempool, mempool_size);
+                mempool = block;
+                mempool_size = new_size;
+                high_water_mark = mempool_size / 2;
+                growth_requested = false;
+                growths.increment();
+            }
+
+            void retire(orderbook::order* block, std::int64_t n)
+            {
+                if (grower == nullptr || !grower->retire_chunk(this, block, n))
+                {
+                    orderbook::pools::free_chunk<orderbook::order>(block, n);
+                }
+            }
 
         public:
-            ring_buffer(std::int64_t ms)
+            ring_buffer(std::int64_t ms, orderbook::pools::pool_grower* grower = nullptr) :
+                grower(grower), spare_state(SPARE_EMPTY), requested_size(0), spare(nullptr), spare_size(0)
             {
                 head = 0;
                 tail = 0;
                 total_volume = 0;
+                enqueued_volume = 0;
+                reduced_head = -1;
+                reduced_last = -1;
                 mempool_size = ms;
-                mempool = static_cast<orderbook::order*>(std::malloc(mempool_size * sizeof(orderbook::order)));
-                for(std::size_t i = 0; i < mempool_size; i++)
-                {
-                    std::cout << "allocating order at index: " << i << "\n";
-                    new (mempool+i) orderbook::order{-2, 0};
-                };
+                chunk_size = ms;
+                high_water_mark = mempool_size / 2; // queues start small, so ask at half full to give the grower a lead.
+                growth_requested = false;
+                std::cout << "allocating " << mempool_size << " orders for ring_buffer.\n";
+                mempool = orderbook::pools::allocate_chunk<orderbook::order>(mempool_size, orderbook::order{-2, 0});
             }
 
             ~ring_buffer()
             {
-                for(std::size_t i = 0; i < mempool_size; i++)
+                orderbook::pools::free_chunk<orderbook::order>(mempool, mempool_size);
+                if (spare_state.load() == SPARE_READY)
                 {
-                    std::cout << "freeing index: " << i << "\n";
-                    (mempool+i)->~order();
-                };
-                std::free(mempool);
+                    orderbook::pools::free_chunk<orderbook::order>(spare, spare_size);
+                }
                 std::cout << "freeing memory of ring_buffer.\n";
             }
 
-            void enqueue(std::int64_t id, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price)
+            void prepare_chunk() override
             {
-                std::cout << "order enequeue, size: " << order_size << "\n";
-            
-                total_volume -= (mempool+(head%mempool_size))->get_size(); // handle wrap around.            
-                if((mempool+(head%mempool_size))->get_side() != -2) {
-                    // ring buffer full drop orders.
-                    std::cout << "OVERWRITING RING BUFFER, DROPPING EXISTING ORDER\n";
+                std::int64_t expected = SPARE_EMPTY;
+                if (spare_state.compare_exchange_strong(expected, SPARE_PREPARING, std::memory_order_acquire))
+                {
+                    spare_size = requested_size.load(std::memory_order_relaxed);
+                    spare = orderbook::pools::allocate_chunk<orderbook::order>(spare_size, orderbook::order{-2, 0});
+                    spare_state.store(SPARE_READY, std::memory_order_release);
                 }
+            }
+
+            void reclaim_chunk(void* chunk, std::int64_t n) override
+            {
+                orderbook::pools::free_chunk<orderbook::order>(static_cast<orderbook::order*>(chunk), n);
+            }
+
+            std::int64_t enqueue(std::int64_t id, std::int64_t order_side, std::int64_t order_size, std::int64_t order_type, std::int64_t order_limit_price)
+            {
+                // Returns the sequence number of the order, its position in the queue for as long as it rests.
+                std::cout << "order enequeue, size: " << order_size << "\n";
 
-                if(order_type == order_type::ORDER_MARKET || order_type == order_type::ORDER_LIMIT){
-                    // market and limit orders
-                    (mempool+(head%mempool_size))->set_market_order_attributes(id, order_size, order_side);
-                } else {
-                    // stop limit orders
-                    (mempool+(head%mempool_size))->set_limit_order_attributes(id, order_size, order_side, order_limit_price);
+                if (head - tail == mempool_size)
+                {
+                    grow();
+                }
+                else if (head - tail >= high_water_mark)
+                {
+                    request_growth();
                 }
+
+                orderbook::order* order = mempool+(head%mempool_size);
+                order->set_order_attributes(id, order_size, order_side, order_type, order_limit_price);
+                order->order_queue_offset = enqueued_volume;
+                enqueued_volume += order_size;
                 total_volume += order_size;
                 head++;
+                depth_high_water_mark.set_max(head - tail);
+                return head - 1;
+            }
+
+            template <typename F>
+            std::int64_t enqueue_bulk(std::int64_t n_orders, F&& set_order)
+            {
+                // Makes room for n_orders with at most one growth, then set_order(k, order) writes the k-th order in
+                // place. Returns the sequence number of the first, the rest follow consecutively.
+                std::int64_t required = head - tail + n_orders;
+                if (required > mempool_size)
+                {
+                    grow_to(((required + chunk_size - 1) / chunk_size) * chunk_size);
+                }
+                std::int64_t first = head;
+                for (std::int64_t k = 0; k < n_orders; k++)
+                {
+                    orderbook::order* order = mempool+((first + k)%mempool_size);
+                    set_order(k, order);
+                    order->order_queue_offset = enqueued_volume;
+                    enqueued_volume += order->get_size();
+                    total_volume += order->get_size();
+                }
+                head += n_orders;
+                depth_high_water_mark.set_max(head - tail);
+                if (head - tail >= high_water_mark)
+                {
+                    request_growth();
+                }
+                return first;
             }
 
             bool is_empty()
@@ -76,15 +275,149 @@ namespace orderbook::queues {
                     head++;
                 }
                 total_volume -= tmp->get_size();
-                tmp->order_side = -1;
+                skip_cancelled();
                 return tmp;
             }
 
+            template <bool check_reserve = true, typename F>
+            batch_fill fill_from_tail(std::int64_t volume, F&& on_fill)
+            {
+                // Fully fills orders from the front of the queue while their running total fits in volume, then
+                // retires them with a single tail update. Stops at the first order that only fits partially and at
+                // icebergs with reserve left, which have to be replenished one at a time. Callers that know the
+                // queue holds no icebergs skip that check.
+                batch_fill filled = {0, 0};
+                std::int64_t sequence = tail;
+                for (; sequence < head; sequence++)
+                {
+                    orderbook::order* order = mempool+(sequence%mempool_size);
+                    if (order->is_cancelled()) continue;
+                    if constexpr (check_reserve)
+                    {
+                        if (order->get_reserve() > 0) break;
+                    }
+                    if (filled.volume + order->get_size() > volume) break;
+                    filled.volume += order->get_size();
+                    filled.orders++;
+                    on_fill(order);
+                }
+                tail = sequence;
+                total_volume -= filled.volume;
+                skip_cancelled();
+                return filled;
+            }
+
+            bool is_live(std::int64_t sequence)
+            {
+                return sequence >= tail && sequence < head && !(mempool+(sequence%mempool_size))->is_cancelled();
+            }
+
+            orderbook::order* at(std::int64_t sequence)
+            {
+                return mempool+(sequence%mempool_size);
+            }
+
+            orderbook::order* find(std::int64_t sequence, std::int64_t id)
+            {
+                // The order with this sequence number, or nullptr if it has since been filled or cancelled.
+                if (sequence < tail || sequence >= head)
+                {
+                    return nullptr;
+                }
+                orderbook::order* order = mempool+(sequence%mempool_size);
+                return (order->get_order_id() == id) ? order : nullptr;
+            }
+
+            void cancel(std::int64_t sequence)
+            {
+                orderbook::order* order = mempool+(sequence%mempool_size);
+                total_volume -= order->get_size();
+                order->cancel();
+                note_reduced(sequence);
+                skip_cancelled();
+            }
+
+            void clear()
+            {
+                // Drops every order in one step. Sequences keep counting from head, so locations held by the order
+                // index for the dropped orders stay invalid without being touched.
+                tail = head;
+                total_volume = 0;
+                reduced_head = -1;
+                reduced_last = -1;
+            }
+
+            queue_position get_queue_position(std::int64_t sequence)
+            {
+                // Orders and volume ahead of a live order. The difference of running offsets counts everything queued
+                // ahead of it since the tail; what has already left is the tail's fills plus the reduced list, which
+                // is empty unless orders ahead were cancelled or reduced in place. O(1) in the common case.
+                if (sequence == tail)
+                {
+                    return {0, 0};
+                }
+                orderbook::order* front = mempool+(tail%mempool_size);
+                queue_position position = {sequence - tail, 0};
+                position.volume_ahead = (mempool+(sequence%mempool_size))->order_queue_offset - front->order_queue_offset -
+                    (get_queued_size(tail) - front->get_size());
+                for (std::int64_t reduced = reduced_head; reduced != -1 && reduced < sequence;)
+                {
+                    orderbook::order* order = mempool+(reduced%mempool_size);
+                    if (reduced > tail)
+                    {
+                        position.volume_ahead -= get_queued_size(reduced) - order->get_size();
+                        position.orders_ahead -= order->is_cancelled() ? 1 : 0;
+                    }
+                    reduced = order->order_next_reduced;
+                }
+                return position;
+            }
+
             std::int64_t get_total_volume()
             {
                 return total_volume;
             }
 
+            orderbook::order* get_mempool()
+            {
+                return mempool;
+            }
+
+            std::int64_t get_capacity()
+            {
+                return mempool_size;
+            }
+
+            std::int64_t get_size()
+            {
+                return head - tail;
+            }
+
+            std::int64_t get_tail()
+            {
+                return tail;
+            }
+
+            std::int64_t get_head()
+            {
+                return head;
+            }
+
+            std::int64_t get_depth_high_water_mark()
+            {
+                return depth_high_water_mark.get();
+            }
+
+            std::int64_t get_growths()
+            {
+                return growths.get();
+            }
+
+            std::int64_t get_growths_on_matching_thread()
+            {
+                return growths_on_matching_thread.get();
+            }
+
             orderbook::order* peek()
             {
                 if(tail == head)
@@ -95,6 +428,13 @@ namespace orderbook::queues {
                 return (mempool+(tail%mempool_size));
             }
 
+            void reduce_size(std::int64_t sequence, std::int64_t size)
+            {
+                total_volume -= size;
+                (mempool+(sequence%mempool_size))->reduce_size(size);
+                note_reduced(sequence);
+            }
+
             void reduce_size_of_tail(std::int64_t size_of_match)
             {
                 total_volume -= size_of_match;
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace orderbook::telemetry {
+    class counter
+    {
+        // Written only by the matching thread, so updates are a relaxed load and store rather than a locked
+        // read-modify-write. Any other thread can read the value without taking a lock.
+        private:
+            std::atomic<std::int64_t> value;
+
+        public:
+            counter() : value(0) {}
+
+            void add(std::int64_t n)
+            {
+                value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            void increment()
+            {
+                add(1);
+            }
+
+            void decrement()
+            {
+                add(-1);
+            }
+
+            void set(std::int64_t n)
+            {
+                value.store(n, std::memory_order_relaxed);
+            }
+
+            void set_max(std::int64_t n)
+            {
+                if (n > value.load(std::memory_order_relaxed))
+                {
+                    value.store(n, std::memory_order_relaxed);
+                }
+            }
+
+            std::int64_t get() const
+            {
+                return value.load(std::memory_order_relaxed);
+            }
+    };
+}
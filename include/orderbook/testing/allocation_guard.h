@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+namespace orderbook::testing {
+
+    class allocation_guard
+    {
+        // Per thread, so the pool grower and other background threads may allocate freely while the matching
+        // thread is guarded.
+        static inline thread_local std::int64_t armed = 0;
+        static inline thread_local std::int64_t allocations = 0;
+        static inline thread_local bool abort_on_allocation = false;
+
+        private:
+            std::int64_t allocations_at_start;
+            bool previous_abort_on_allocation;
+
+        public:
+            allocation_guard(bool abort = false)
+            {
+                allocations_at_start = allocations;
+                previous_abort_on_allocation = abort_on_allocation;
+                abort_on_allocation = abort;
+                armed++;
+            }
+
+            ~allocation_guard()
+            {
+                armed--;
+                abort_on_allocation = previous_abort_on_allocation;
+            }
+
+            std::int64_t get_allocations()
+            {
+                return allocations - allocations_at_start;
+            }
+
+            static void record_allocation()
+            {
+                // Called from inside the allocator, so it must not allocate or use iostreams itself.
+                if (armed == 0) return;
+                allocations++;
+                if (abort_on_allocation)
+                {
+                    const char message[] = "ALLOCATION ON GUARDED HOT PATH\n";
+                    ssize_t written = write(2, message, sizeof(message) - 1);
+                    (void)written;
+                    std::abort();
+                }
+            }
+    };
+}
+
+#ifdef ORDERBOOK_ALLOCATION_HOOKS
+// Define ORDERBOOK_ALLOCATION_HOOKS in exactly one translation unit of a test or benchmark binary to route the
+// global allocators through allocation_guard. The hooks forward to glibc's underlying allocator.
+extern "C" {
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t n, std::size_t size);
+    void* __libc_realloc(void* ptr, std::size_t size);
+    void* __libc_memalign(std::size_t alignment, std::size_t size);
+    void __libc_free(void* ptr);
+
+    void* malloc(std::size_t size)
+    {
+        orderbook::testing::allocation_guard::record_allocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(std::size_t n, std::size_t size)
+    {
+        orderbook::testing::allocation_guard::record_allocation();
+        return __libc_calloc(n, size);
+    }
+
+    void* realloc(void* ptr, std::size_t size)
+    {
+        orderbook::testing::allocation_guard::record_allocation();
+        return __libc_realloc(ptr, size);
+    }
+
+    void free(void* ptr)
+    {
+        __libc_free(ptr);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    orderbook::testing::allocation_guard::record_allocation();
+    void* ptr = __libc_malloc(size ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    orderbook::testing::allocation_guard::record_allocation();
+    return __libc_malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    orderbook::testing::allocation_guard::record_allocation();
+    void* ptr = __libc_memalign(static_cast<std::size_t>(alignment), size ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { __libc_free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { __libc_free(ptr); }
+#endif
@@ -1,18 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
 
 namespace orderbook {
     class tick_level
     {
+        // 16 bytes, four nodes per cache line. Children are object_pool handles rather than pointers and tick levels
+        // are bounded by the tick level bitmap, far below 2^31.
         public:
-            std::int64_t value;
-            std::int64_t height;
-            orderbook::tick_level* left;
-            orderbook::tick_level* right;
+            std::int32_t value;
+            std::int32_t height;
+            std::uint32_t left;
+            std::uint32_t right;
 
-            tick_level(std::int64_t value) : value(value), left(nullptr), right(nullptr), height(1) {}
+            tick_level(std::int64_t value) : value(static_cast<std::int32_t>(value)), height(1), left(~0u), right(~0u) {}
 
             ~tick_level()
             {
                 std::cout << "deleting price level.\n";
             }
     };
+
+    static_assert(sizeof(orderbook::tick_level) == 16);
 }
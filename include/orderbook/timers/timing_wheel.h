@@ -0,0 +1,193 @@
+#pragma once
+#include <cstdint>
+#include "orderbook/pools/object_pool.h"
+#include "orderbook/telemetry/counter.h"
+
+namespace orderbook::timers {
+
+    struct timer
+    {
+        std::int64_t id;
+        std::int64_t expiry;
+        timer* next;
+    };
+
+    class timing_wheel
+    {
+        // Hierarchical timing wheel over the engine clock. Level l has 64 slots of 64^l ticks each; a timer sits at
+        // the lowest level whose current rotation contains its expiry and moves down one level each time its slot
+        // comes round, so scheduling and expiring are O(1) per timer. Timers beyond 64^4 ticks wait in an overflow
+        // list that is re-sorted once per top-level rotation.
+        std::int64_t static constexpr SLOT_BITS = 6;
+        std::int64_t static constexpr SLOTS = 1 << SLOT_BITS;
+        std::int64_t static constexpr SLOT_MASK = SLOTS - 1;
+        std::int64_t static constexpr LEVELS = 4;
+
+        private:
+            timer* slots[LEVELS][SLOTS];
+            std::uint64_t occupied[LEVELS]; // one bit per non-empty slot.
+            timer* overflow;
+            orderbook::pools::object_pool<timer>* timer_pool;
+            std::int64_t current_time;
+            orderbook::telemetry::counter n_pending;
+
+            void insert(timer* t)
+            {
+                for (std::int64_t l = 0; l < LEVELS; l++)
+                {
+                    std::int64_t rotation_bits = SLOT_BITS * (l + 1);
+                    if ((t->expiry >> rotation_bits) == (current_time >> rotation_bits))
+                    {
+                        std::int64_t slot = (t->expiry >> (SLOT_BITS * l)) & SLOT_MASK;
+                        t->next = slots[l][slot];
+                        slots[l][slot] = t;
+                        occupied[l] |= 1ULL << slot;
+                        return;
+                    }
+                }
+                t->next = overflow;
+                overflow = t;
+            }
+
+            void reinsert(timer* list)
+            {
+                while (list != nullptr)
+                {
+                    timer* next = list->next;
+                    insert(list);
+                    list = next;
+                }
+            }
+
+            void cascade(std::int64_t level)
+            {
+                std::int64_t slot = (current_time >> (SLOT_BITS * level)) & SLOT_MASK;
+                timer* list = slots[level][slot];
+                slots[level][slot] = nullptr;
+                occupied[level] &= ~(1ULL << slot);
+                reinsert(list);
+            }
+
+            void cascade_all()
+            {
+                // Called when the clock crosses a level 0 rotation. Higher levels go first, so their timers can land
+                // in the slots of the levels below that are about to be cascaded in the same step.
+                if ((current_time & ((1LL << (SLOT_BITS * LEVELS)) - 1)) == 0)
+                {
+                    timer* list = overflow;
+                    overflow = nullptr;
+                    reinsert(list);
+                }
+                for (std::int64_t l = LEVELS - 1; l > 0; l--)
+                {
+                    if ((current_time & ((1LL << (SLOT_BITS * l)) - 1)) == 0)
+                    {
+                        cascade(l);
+                    }
+                }
+            }
+
+            std::int64_t next_event_time()
+            {
+                // The next tick at which a level 0 slot expires or a higher level slot cascades. A level's rotation
+                // ends before any slot of the levels above comes round, so the lowest level with an occupied slot
+                // ahead of the clock decides. With every level empty, the next overflow re-sort.
+                for (std::int64_t l = 0; l < LEVELS; l++)
+                {
+                    std::int64_t shift = SLOT_BITS * l;
+                    std::int64_t slot = (current_time >> shift) & SLOT_MASK;
+                    std::uint64_t ahead = (slot == SLOT_MASK) ? 0 : occupied[l] & (~0ULL << (slot + 1));
+                    if (ahead != 0)
+                    {
+                        std::int64_t rotation_start = (current_time >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+                        return rotation_start + (static_cast<std::int64_t>(__builtin_ctzll(ahead)) << shift);
+                    }
+                }
+                return ((current_time >> (SLOT_BITS * LEVELS)) + 1) << (SLOT_BITS * LEVELS);
+            }
+
+        public:
+            timing_wheel(std::int64_t n, orderbook::pools::pool_grower* grower = nullptr)
+            {
+                for (std::int64_t l = 0; l < LEVELS; l++)
+                {
+                    occupied[l] = 0;
+                    for (std::int64_t s = 0; s < SLOTS; s++)
+                    {
+                        slots[l][s] = nullptr;
+                    }
+                }
+                overflow = nullptr;
+                current_time = 0;
+                timer_pool = new orderbook::pools::object_pool<timer>{n, timer{-1, -1, nullptr}, grower};
+            }
+
+            ~timing_wheel()
+            {
+                delete timer_pool;
+            }
+
+            bool schedule(std::int64_t id, std::int64_t expiry)
+            {
+                // Expiries at or before the current time fire on the next tick.
+                timer* t = timer_pool->aquire();
+                if (t == nullptr)
+                {
+                    return false;
+                }
+                t->id = id;
+                t->expiry = (expiry > current_time) ? expiry : current_time + 1;
+                insert(t);
+                n_pending.increment();
+                return true;
+            }
+
+            template <typename F>
+            void advance(std::int64_t now, F&& on_expire)
+            {
+                // Jumps straight to the next occupied slot at any level, using the occupancy masks, so an idle clock
+                // costs one step per occupied slot rather than one per 64 ticks, and nothing when no timer is pending.
+                while (current_time < now)
+                {
+                    if (n_pending.get() == 0)
+                    {
+                        current_time = now;
+                        break;
+                    }
+                    std::int64_t next = next_event_time();
+                    if (next > now)
+                    {
+                        current_time = now;
+                        break;
+                    }
+                    current_time = next;
+                    if ((current_time & SLOT_MASK) == 0)
+                    {
+                        cascade_all();
+                    }
+                    std::int64_t slot = current_time & SLOT_MASK;
+                    timer* list = slots[0][slot];
+                    slots[0][slot] = nullptr;
+                    occupied[0] &= ~(1ULL << slot);
+                    while (list != nullptr)
+                    {
+                        timer* next_timer = list->next;
+                        on_expire(list->id);
+                        timer_pool->release(list);
+                        n_pending.decrement();
+                        list = next_timer;
+                    }
+                }
+            }
+
+            std::int64_t get_time()
+            {
+                return current_time;
+            }
+
+            std::int64_t get_pending()
+            {
+                return n_pending.get();
+            }
+    };
+}
@@ -1,6 +1,8 @@
+#pragma once
 #include <iostream>
 #include "orderbook/tick_level/tick_level.h"
-#include "orderbook/bitmaps/mempool_bitmap.h"
+#include "orderbook/pools/object_pool.h"
+#include "orderbook/telemetry/counter.h"
 #include "orderbook/bitmaps/tick_level_bitmap.h"
 #include "orderbook/maps/order_map.h"
 
@@ -8,17 +10,29 @@ namespace orderbook::trees {
 
     class avl_tree
     {
+        // Nodes are addressed by 32-bit object_pool handles. Insert and remove walk down once, recording the path
+        // on a stack, then rebalance back up it until a subtree's height is unchanged. An AVL tree of 2^31 nodes is
+        // under 46 levels deep, so the path always fits.
+        std::int64_t static constexpr MAX_DEPTH = 64;
+        std::uint32_t static constexpr NO_NODE = orderbook::pools::object_pool<orderbook::tick_level>::NO_HANDLE;
+
         private:
 
-            orderbook::tick_level* memory_pool;
-            orderbook::bitmaps::mempool_bitmap* mp_bm;
+            orderbook::pools::object_pool<orderbook::tick_level>* node_pool;
             orderbook::bitmaps::tick_level_bitmap* tl_bm;
-            orderbook::tick_level* root;
+            std::uint32_t root;
             std::int64_t n_tick_levels;
-            
-            std::int64_t get_height(orderbook::tick_level* tick_level)
+            orderbook::telemetry::counter n_live_levels;
+            std::uint32_t path[MAX_DEPTH];
+
+            orderbook::tick_level* node(std::uint32_t handle)
+            {
+                return node_pool->from_handle(handle);
+            }
+
+            std::int64_t get_height(std::uint32_t handle)
             {
-                return tick_level ? tick_level->height : 0;
+                return (handle == NO_NODE) ? 0 : node(handle)->height;
             }
 
             std::int64_t get_max_child_height(orderbook::tick_level* tick_level)
@@ -26,192 +40,255 @@ namespace orderbook::trees {
                 return std::max(get_height(tick_level->left), get_height(tick_level->right));
             }
 
-            std::int64_t get_balance_factor(orderbook::tick_level* tick_level)
+            std::int64_t get_balance_factor(std::uint32_t handle)
             {
-                return tick_level ? get_height(tick_level->left) - get_height(tick_level->right) : 0;
+                if (handle == NO_NODE) return 0;
+                orderbook::tick_level* tick_level = node(handle);
+                return get_height(tick_level->left) - get_height(tick_level->right);
             }
 
-            orderbook::tick_level* rotate_left(orderbook::tick_level* tick_level)
+            std::uint32_t rotate_left(std::uint32_t handle)
             {
-                orderbook::tick_level* right = tick_level->right;
-                orderbook::tick_level* right_left_child = right->left;
-                right->left = tick_level;
-                tick_level->right = right_left_child;
+                orderbook::tick_level* tick_level = node(handle);
+                std::uint32_t right_handle = tick_level->right;
+                orderbook::tick_level* right = node(right_handle);
+                tick_level->right = right->left;
+                right->left = handle;
                 tick_level->height = 1 + get_max_child_height(tick_level);
                 right->height = 1 + get_max_child_height(right);
-                return right;
+                return right_handle;
             }
 
-            orderbook::tick_level* rotate_right(orderbook::tick_level* tick_level)
+            std::uint32_t rotate_right(std::uint32_t handle)
             {
-                orderbook::tick_level* left = tick_level->left;
-                orderbook::tick_level* left_right_child = left->right;
-                left->right = tick_level;
-                tick_level->left = left_right_child;
+                orderbook::tick_level* tick_level = node(handle);
+                std::uint32_t left_handle = tick_level->left;
+                orderbook::tick_level* left = node(left_handle);
+                tick_level->left = left->right;
+                left->right = handle;
                 tick_level->height = 1 + get_max_child_height(tick_level);
                 left->height = 1 + get_max_child_height(left);
-                return left;
+                return left_handle;
             }
 
-            orderbook::tick_level* insert(orderbook::tick_level* tl, int tick_level)
+            std::uint32_t rebalance(std::uint32_t handle)
             {
-                if (tl == nullptr)
+                // Returns the root of the rebalanced subtree, the same rotations serve insert and remove.
+                orderbook::tick_level* tick_level = node(handle);
+                tick_level->height = 1 + get_max_child_height(tick_level);
+                std::int64_t balance_factor = get_height(tick_level->left) - get_height(tick_level->right);
+                if (balance_factor > 1)
                 {
-                    size_t free_index = mp_bm->aquire();
-                    if (free_index < 0 || free_index >= n_tick_levels)
+                    if (get_balance_factor(tick_level->left) < 0)
                     {
-                        std::cout << "NO FREE PRICE LEVELS MUST ALLOCATE ADDITIONAL SPACE.\n";
-                        return nullptr;
-                    };
-                    orderbook::tick_level* free_level = (memory_pool+free_index);
-                    free_level->value = tick_level; // set tick_level value of reused node;
-                    free_level->left = free_level->right = nullptr; // ensure left and right of reused node are nullptr;
-                    free_level->height = 1;
-                    tl_bm->set(tick_level);
-                    return free_level;
-                } else if (tick_level < tl->value){
-                    tl->left = insert(tl->left, tick_level);
-                } else {
-                    tl->right = insert(tl->right, tick_level);
+                        tick_level->left = rotate_left(tick_level->left);
+                    }
+                    return rotate_right(handle);
                 }
-                tl->height = 1 + get_max_child_height(tl);
-                int balance_factor = get_balance_factor(tl);
-                if (balance_factor > 1 && tick_level < tl->left->value)
+                if (balance_factor < -1)
                 {
-                    return rotate_right(tl);
+                    if (get_balance_factor(tick_level->right) > 0)
+                    {
+                        tick_level->right = rotate_right(tick_level->right);
+                    }
+                    return rotate_left(handle);
                 }
-                if (balance_factor < -1 && tick_level > tl->right->value)
+                return handle;
+            }
+
+            void replace_child(std::int64_t depth, std::uint32_t old_child, std::uint32_t new_child)
+            {
+                // Points the node at path[depth] (the root when depth is negative) at new_child instead of old_child.
+                if (depth < 0)
                 {
-                    return rotate_left(tl);
+                    root = new_child;
+                    return;
                 }
-                if (balance_factor > 1 && tick_level > tl->left->value)
+                orderbook::tick_level* parent = node(path[depth]);
+                if (parent->left == old_child)
                 {
-                    tl->left = rotate_left(tl->left);
-                    return rotate_right(tl);
+                    parent->left = new_child;
                 }
-                if (balance_factor < -1 && tick_level < tl->right->value)
+                else
                 {
-                    tl->right = rotate_right(tl->right);
-                    return rotate_left(tl);
+                    parent->right = new_child;
                 }
-                return tl;
             }
 
-            orderbook::tick_level* remove(orderbook::tick_level* tl, int tick_level)
+            void retrace(std::int64_t depth)
             {
-                if (tl == nullptr) {
-                    return tl;
-                }
-                if (tick_level < tl->value) {
-                    tl->left = remove(tl->left, tick_level);
-                } else if (tick_level > tl->value) {
-                    tl->right = remove(tl->right, tick_level);
-                } else {
-                    if (!tl->left || !tl->right)
+                // Rebalances path[depth] up to the root, stopping once a subtree comes out as tall as it went in.
+                for (; depth >= 0; depth--)
+                {
+                    std::uint32_t handle = path[depth];
+                    std::int64_t old_height = node(handle)->height;
+                    std::uint32_t balanced = rebalance(handle);
+                    if (balanced != handle)
+                    {
+                        replace_child(depth - 1, handle, balanced);
+                    }
+                    if (node(balanced)->height == old_height)
                     {
-                        orderbook::tick_level* temp = tl->left ? tl->left : tl->right;
-                        std::size_t index = tl - memory_pool;
-                        tl->value = -1;
-                        mp_bm->release(index);
-                        tl_bm->unset(tick_level);
-                        std::cout << "RELEASING NODE\n";
-                        return temp;
+                        return;
                     }
-                    orderbook::tick_level* tmp = get_min(tl->right);
-                    tl->value = tmp->value;
-                    tl->right = remove(tl->right, tmp->value);
                 }
-                tl->height = 1 + this->get_max_child_height(tl);
-                int balance_factor = get_balance_factor(tl);
-                if (balance_factor > 1 && get_balance_factor(tl->left) >= 0)
+            }
+
+            bool insert_level(std::int64_t tick_level)
+            {
+                std::int64_t depth = 0;
+                for (std::uint32_t handle = root; handle != NO_NODE;)
+                {
+                    path[depth++] = handle;
+                    orderbook::tick_level* current = node(handle);
+                    handle = (tick_level < current->value) ? current->left : current->right;
+                }
+                std::uint32_t free_handle = node_pool->aquire_handle();
+                if (free_handle == NO_NODE)
                 {
-                    return rotate_right(tl);
+                    std::cout << "NO FREE PRICE LEVELS, NODE POOL AT MAXIMUM CAPACITY.\n";
+                    return false;
                 }
-                if (balance_factor < -1 && get_balance_factor(tl->right) <= 0)
+                orderbook::tick_level* free_level = node(free_handle);
+                free_level->value = static_cast<std::int32_t>(tick_level); // set tick_level value of reused node;
+                free_level->left = free_level->right = NO_NODE; // ensure left and right of reused node are empty;
+                free_level->height = 1;
+                tl_bm->set(tick_level);
+                n_live_levels.increment();
+                if (depth == 0)
                 {
-                    return rotate_left(tl);
+                    root = free_handle;
+                    return true;
                 }
-                if (balance_factor > 1 && get_balance_factor(tl->left) < 0)
+                orderbook::tick_level* parent = node(path[depth - 1]);
+                if (tick_level < parent->value)
                 {
-                    tl->left = rotate_left(tl->left);
-                    return rotate_right(tl);
+                    parent->left = free_handle;
                 }
-                if (balance_factor < -1 && get_balance_factor(tl->right) > 0)
+                else
                 {
-                    tl->right = rotate_right(tl->right);
-                    return rotate_left(tl);
+                    parent->right = free_handle;
                 }
-                return tl;
+                retrace(depth - 1);
+                return true;
             }
 
-            orderbook::tick_level* get_min(orderbook::tick_level* root)
+            void remove_level(std::int64_t tick_level)
             {
-                orderbook::tick_level* current = root;
-                while (current && current->left)
-                    current = current->left;
-                return current;
-            }
-
-            orderbook::tick_level* get_max(orderbook::tick_level* root)
-            {
-                orderbook::tick_level* current = root;
-                while (current && current->right)
-                    current = current->right;
-                return current;
+                std::int64_t depth = 0;
+                std::uint32_t handle = root;
+                while (handle != NO_NODE && node(handle)->value != tick_level)
+                {
+                    path[depth++] = handle;
+                    orderbook::tick_level* current = node(handle);
+                    handle = (tick_level < current->value) ? current->left : current->right;
+                }
+                if (handle == NO_NODE)
+                {
+                    return;
+                }
+                orderbook::tick_level* removed = node(handle);
+                if (removed->left != NO_NODE && removed->right != NO_NODE)
+                {
+                    // Relink the in-order successor into the removed node's place rather than copying its value,
+                    // so a node never changes tick level while it is in the tree.
+                    std::int64_t removed_depth = depth;
+                    path[depth++] = handle;
+                    std::uint32_t successor_handle = removed->right;
+                    while (node(successor_handle)->left != NO_NODE)
+                    {
+                        path[depth++] = successor_handle;
+                        successor_handle = node(successor_handle)->left;
+                    }
+                    orderbook::tick_level* successor = node(successor_handle);
+                    if (path[depth - 1] == handle)
+                    {
+                        removed->right = successor->right;
+                    }
+                    else
+                    {
+                        node(path[depth - 1])->left = successor->right;
+                    }
+                    successor->left = removed->left;
+                    successor->right = removed->right;
+                    successor->height = removed->height;
+                    replace_child(removed_depth - 1, handle, successor_handle);
+                    path[removed_depth] = successor_handle;
+                }
+                else
+                {
+                    replace_child(depth - 1, handle, (removed->left != NO_NODE) ? removed->left : removed->right);
+                }
+                removed->value = -1;
+                node_pool->release_handle(handle);
+                n_live_levels.decrement();
+                std::cout << "RELEASING NODE\n";
+                retrace(depth - 1);
             }
 
-            orderbook::tick_level* get_min_tick_level()
+            std::uint32_t build(const std::int64_t* tick_levels, std::int64_t n)
             {
-                return get_min(root);
+                // Each subtree is rooted at the middle of its range, so sibling heights differ by at most one.
+                if (n == 0)
+                {
+                    return NO_NODE;
+                }
+                std::int64_t mid = n / 2;
+                std::uint32_t handle = node_pool->aquire_handle();
+                orderbook::tick_level* tick_level = node(handle);
+                tick_level->value = static_cast<std::int32_t>(tick_levels[mid]);
+                tick_level->left = build(tick_levels, mid);
+                tick_level->right = build(tick_levels + mid + 1, n - mid - 1);
+                tick_level->height = 1 + get_max_child_height(tick_level);
+                tl_bm->set(tick_levels[mid]);
+                return handle;
             }
 
-            orderbook::tick_level* get_max_tick_level()
+            std::uint32_t get_min(std::uint32_t handle)
             {
-                return get_max(root);
+                while (handle != NO_NODE && node(handle)->left != NO_NODE)
+                    handle = node(handle)->left;
+                return handle;
             }
 
-            std::int64_t eager_allocation()
+            std::uint32_t get_max(std::uint32_t handle)
             {
-                for(std::int64_t i = 0; i < n_tick_levels; i++)
-                {
-                    new (memory_pool+i) orderbook::tick_level{-1};
-                    std::cout << "allocating tick level.\n";
-                };
-                return 0;
+                while (handle != NO_NODE && node(handle)->right != NO_NODE)
+                    handle = node(handle)->right;
+                return handle;
             }
 
-            void traverse(orderbook::tick_level* curr)
+            void traverse(std::uint32_t handle)
             {
-                if(curr->left != nullptr)
+                orderbook::tick_level* curr = node(handle);
+                if(curr->left != NO_NODE)
                 {
                     traverse(curr->left);
                 }
                 std::cout << "tree value: " << curr->value << ".\n";
-                if(curr->right != nullptr)
+                if(curr->right != NO_NODE)
                 {
                     traverse(curr->right);
                 }
             }
 
         public:
-            avl_tree(std::int64_t n)
+            avl_tree(std::int64_t n, orderbook::pools::pool_grower* grower = nullptr)
             {
-                root = nullptr;
+                root = NO_NODE;
                 n_tick_levels = n;
-                memory_pool = static_cast<orderbook::tick_level*>(std::malloc(n * sizeof(orderbook::tick_level)));
-                mp_bm = new orderbook::bitmaps::mempool_bitmap{};
-                tl_bm = new orderbook::bitmaps::tick_level_bitmap{};
-                eager_allocation();
+                node_pool = new orderbook::pools::object_pool<orderbook::tick_level>{n, orderbook::tick_level{-1}, grower};
+                tl_bm = new orderbook::bitmaps::tick_level_bitmap{n_tick_levels}; // sized to the book, so level scans stop at its last tick.
             }
 
             std::int64_t get_min_value()
             {
-                return get_min(root)->value;
+                return node(get_min(root))->value;
             }
 
             std::int64_t get_max_value()
             {
-                return get_max(root)->value;
+                return node(get_max(root))->value;
             }
 
 
@@ -220,49 +297,92 @@ namespace orderbook::trees {
                 return tl_bm->is_set(tick_level);
             }
 
-            void insert(std::int64_t tick_level)
+            std::int64_t find_next_level(std::int64_t tick_level)
+            {
+                // First level in the tree at or above tick_level, or -1, from the occupancy bitmap.
+                return tl_bm->find_next_set(tick_level);
+            }
+
+            bool insert(std::int64_t tick_level)
             {
+                // Returns false if the level could not be inserted because the node pool is exhausted.
                 if(tl_bm->is_set(tick_level))
                 {
                     std::cout << "VALUE ALREADY IN TREE!\n";
-                    return;
+                    return true;
                 }
-                root = insert(root, tick_level);
+                return insert_level(tick_level);
+            }
+
+            bool bulk_load(const std::int64_t* tick_levels, std::int64_t n)
+            {
+                // Builds a perfectly balanced tree from n strictly increasing tick levels in O(n), instead of n
+                // inserts. Only an empty tree can be loaded, returns false otherwise.
+                if (!is_empty())
+                {
+                    return false;
+                }
+                root = build(tick_levels, n);
+                n_live_levels.add(n);
+                return true;
             }
 
             void remove(std::int64_t tick_level)
             {
-                root = remove(root, tick_level);
+                if(!tl_bm->is_set(tick_level))
+                {
+                    return;
+                }
+                remove_level(tick_level);
+                tl_bm->unset(tick_level);
             }
 
             void remove_min()
             {
-                root = remove(root, get_min_value());
+                remove(get_min_value());
             }
 
             void remove_max()
             {
-                root = remove(root, get_max_value());
+                remove(get_max_value());
             }
 
             void print()
             {
-                traverse(root);
+                if (root != NO_NODE)
+                {
+                    traverse(root);
+                }
             }
 
             bool is_empty() {
-                return root == nullptr;
+                return root == NO_NODE;
+            }
+
+            std::int64_t get_height()
+            {
+                return get_height(root);
+            }
+
+            orderbook::tick_level* get_memory_pool()
+            {
+                return node_pool->get_mempool();
+            }
+
+            orderbook::pools::object_pool<orderbook::tick_level>* get_node_pool()
+            {
+                return node_pool;
+            }
+
+            std::int64_t get_n_live_levels()
+            {
+                return n_live_levels.get();
             }
 
             ~avl_tree()
             {
-                for(std::int64_t i = 0; i < n_tick_levels; i++)
-                {
-                    (memory_pool+i)->~tick_level();
-                };
                 std::cout << "destroying tree, freeing memory.\n";
-                std::free(memory_pool);
-                delete mp_bm;
+                delete node_pool;
                 delete tl_bm;
             }
     };
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+
+namespace orderbook::trees {
+
+    class fenwick_tree
+    {
+        // Binary indexed tree over tick levels: point updates and prefix sums are both O(log n).
+        private:
+            std::int64_t* tree;
+            std::int64_t n_tick_levels;
+            std::int64_t total;
+
+        public:
+            fenwick_tree(std::int64_t n)
+            {
+                n_tick_levels = n;
+                total = 0;
+                tree = static_cast<std::int64_t*>(std::calloc(n_tick_levels + 1, sizeof(std::int64_t)));
+            }
+
+            ~fenwick_tree()
+            {
+                std::free(tree);
+            }
+
+            void add(std::int64_t tick_level, std::int64_t delta)
+            {
+                total += delta;
+                for (std::int64_t i = tick_level + 1; i <= n_tick_levels; i += i & -i)
+                {
+                    tree[i] += delta;
+                }
+            }
+
+            std::int64_t prefix_sum(std::int64_t tick_level)
+            {
+                // Sum of tick levels 0..tick_level inclusive.
+                if (tick_level >= n_tick_levels) tick_level = n_tick_levels - 1;
+                std::int64_t sum = 0;
+                for (std::int64_t i = tick_level + 1; i > 0; i -= i & -i)
+                {
+                    sum += tree[i];
+                }
+                return sum;
+            }
+
+            std::int64_t suffix_sum(std::int64_t tick_level)
+            {
+                // Sum of tick levels tick_level..n-1 inclusive.
+                return total - prefix_sum(tick_level - 1);
+            }
+
+            std::int64_t get_total()
+            {
+                return total;
+            }
+    };
+}
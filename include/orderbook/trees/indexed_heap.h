@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <cstdlib>
+
+namespace orderbook::trees {
+
+    class indexed_heap
+    {
+        // A binary min-heap over a fixed set of items 0..n-1, each with a key. Positions are tracked per item, so
+        // the key of any item can be changed in O(log n) and the item with the smallest key is always at the top.
+        // Items never leave the heap, an item with nothing to offer is given a key that sorts it last.
+        private:
+            std::int64_t* keys; // by item.
+            std::int64_t* heap; // items in heap order.
+            std::int64_t* positions; // index of each item in heap.
+            std::int64_t n_items;
+
+            void swap(std::int64_t i, std::int64_t j)
+            {
+                std::int64_t item = heap[i];
+                heap[i] = heap[j];
+                heap[j] = item;
+                positions[heap[i]] = i;
+                positions[heap[j]] = j;
+            }
+
+            void sift_up(std::int64_t i)
+            {
+                while (i > 0 && keys[heap[i]] < keys[heap[(i - 1) / 2]])
+                {
+                    swap(i, (i - 1) / 2);
+                    i = (i - 1) / 2;
+                }
+            }
+
+            void sift_down(std::int64_t i)
+            {
+                while (true)
+                {
+                    std::int64_t smallest = i;
+                    std::int64_t left = 2 * i + 1;
+                    std::int64_t right = left + 1;
+                    if (left < n_items && keys[heap[left]] < keys[heap[smallest]]) smallest = left;
+                    if (right < n_items && keys[heap[right]] < keys[heap[smallest]]) smallest = right;
+                    if (smallest == i) return;
+                    swap(i, smallest);
+                    i = smallest;
+                }
+            }
+
+        public:
+            indexed_heap(std::int64_t n, std::int64_t initial_key) : n_items(n)
+            {
+                keys = static_cast<std::int64_t*>(std::malloc(n_items * sizeof(std::int64_t)));
+                heap = static_cast<std::int64_t*>(std::malloc(n_items * sizeof(std::int64_t)));
+                positions = static_cast<std::int64_t*>(std::malloc(n_items * sizeof(std::int64_t)));
+                for (std::int64_t i = 0; i < n_items; i++)
+                {
+                    keys[i] = initial_key;
+                    heap[i] = i;
+                    positions[i] = i;
+                }
+            }
+
+            ~indexed_heap()
+            {
+                std::free(keys);
+                std::free(heap);
+                std::free(positions);
+            }
+
+            void update(std::int64_t item, std::int64_t key)
+            {
+                std::int64_t old_key = keys[item];
+                keys[item] = key;
+                if (key < old_key)
+                {
+                    sift_up(positions[item]);
+                }
+                else if (key > old_key)
+                {
+                    sift_down(positions[item]);
+                }
+            }
+
+            std::int64_t get_top()
+            {
+                return heap[0];
+            }
+
+            std::int64_t get_top_key()
+            {
+                return keys[heap[0]];
+            }
+
+            std::int64_t get_key(std::int64_t item)
+            {
+                return keys[item];
+            }
+
+            std::int64_t get_size()
+            {
+                return n_items;
+            }
+    };
+}
@@ -0,0 +1,221 @@
+#pragma once
+#include <iostream>
+#include "orderbook/enums/enums.h"
+#include "orderbook/trees/avl_tree.h"
+#include "orderbook/telemetry/counter.h"
+
+namespace orderbook::trees {
+
+    class price_ladder
+    {
+        // The price index for one side of the book. The best HOT_LEVELS levels are kept sorted best-first in a
+        // single cache line and the rest live in an avl_tree. Every hot level is better than every cold one, and
+        // the hot array is only short of full while the tree is empty, so the best price is always hot[0].
+        // Levels are stored as tick * direction, which orders both sides ascending from the best price.
+        std::int64_t static constexpr HOT_LEVELS = 8;
+
+        private:
+            std::int64_t hot[HOT_LEVELS];
+            std::int64_t n_hot;
+            std::int64_t direction; // -1 for bids, the highest bid is best. 1 for asks.
+            orderbook::trees::avl_tree* cold;
+            orderbook::telemetry::counter n_live_levels;
+
+            std::int64_t key(std::int64_t tick_level)
+            {
+                return tick_level * direction;
+            }
+
+            std::int64_t find_hot(std::int64_t k)
+            {
+                for (std::int64_t i = 0; i < n_hot; i++)
+                {
+                    if (hot[i] == k) return i;
+                }
+                return -1;
+            }
+
+            std::int64_t get_best_cold_value()
+            {
+                return (direction < 0) ? cold->get_max_value() : cold->get_min_value();
+            }
+
+            std::int64_t get_worst_value()
+            {
+                if (cold->is_empty())
+                {
+                    return hot[n_hot - 1] * direction;
+                }
+                return (direction < 0) ? cold->get_min_value() : cold->get_max_value();
+            }
+
+            bool insert_hot(std::int64_t k)
+            {
+                // Shift worse levels back one slot. When the array is full the worst hot level is demoted first, and
+                // nothing changes if the tree has no node left for it.
+                if (n_hot == HOT_LEVELS)
+                {
+                    if (!cold->insert(hot[HOT_LEVELS - 1] * direction)) return false;
+                    n_hot--;
+                }
+                std::int64_t i = n_hot;
+                for (; i > 0 && hot[i - 1] > k; i--)
+                {
+                    hot[i] = hot[i - 1];
+                }
+                hot[i] = k;
+                n_hot++;
+                return true;
+            }
+
+            void remove_hot(std::int64_t i)
+            {
+                // Close the gap, then promote the best cold level into the freed slot at the back.
+                for (; i < n_hot - 1; i++)
+                {
+                    hot[i] = hot[i + 1];
+                }
+                n_hot--;
+                if (!cold->is_empty())
+                {
+                    std::int64_t promoted = get_best_cold_value();
+                    cold->remove(promoted);
+                    hot[n_hot++] = key(promoted);
+                }
+            }
+
+        public:
+            price_ladder(std::int64_t n, std::int64_t side, orderbook::pools::pool_grower* grower = nullptr)
+            {
+                n_hot = 0;
+                direction = (side == order_side::BID) ? -1 : 1;
+                cold = new orderbook::trees::avl_tree{n, grower};
+            }
+
+            bool insert(std::int64_t tick_level)
+            {
+                // Returns false if the level is not in the ladder afterwards, because the tree's node pool is exhausted.
+                std::int64_t k = key(tick_level);
+                if (n_hot == HOT_LEVELS && k > hot[HOT_LEVELS - 1])
+                {
+                    if (cold->contains(tick_level)) return true;
+                    if (!cold->insert(tick_level)) return false;
+                }
+                else
+                {
+                    if (find_hot(k) >= 0) return true;
+                    if (!insert_hot(k)) return false;
+                }
+                n_live_levels.increment();
+                return true;
+            }
+
+            bool bulk_load(const std::int64_t* tick_levels, std::int64_t n)
+            {
+                // Loads n strictly increasing tick levels into an empty ladder: the best HOT_LEVELS fill the array and
+                // the rest build the tree in one pass. Returns false if the ladder is not empty.
+                if (!is_empty())
+                {
+                    return false;
+                }
+                n_hot = std::min(n, HOT_LEVELS);
+                for (std::int64_t i = 0; i < n_hot; i++)
+                {
+                    // The best bids are at the end of the range, the best asks at the start.
+                    hot[i] = key((direction < 0) ? tick_levels[n - 1 - i] : tick_levels[i]);
+                }
+                cold->bulk_load((direction < 0) ? tick_levels : tick_levels + n_hot, n - n_hot);
+                n_live_levels.add(n);
+                return true;
+            }
+
+            void remove(std::int64_t tick_level)
+            {
+                std::int64_t i = find_hot(key(tick_level));
+                if (i >= 0)
+                {
+                    remove_hot(i);
+                }
+                else if (cold->contains(tick_level))
+                {
+                    cold->remove(tick_level);
+                }
+                else
+                {
+                    return;
+                }
+                n_live_levels.decrement();
+            }
+
+            bool contains(std::int64_t tick_level)
+            {
+                return find_hot(key(tick_level)) >= 0 || cold->contains(tick_level);
+            }
+
+            std::int64_t find_next_level(std::int64_t tick_level)
+            {
+                // First live level at or above tick_level, or -1. Visits only occupied levels when walking a range.
+                std::int64_t next = cold->find_next_level(tick_level);
+                for (std::int64_t i = 0; i < n_hot; i++)
+                {
+                    std::int64_t hot_level = hot[i] * direction;
+                    if (hot_level >= tick_level && (next == -1 || hot_level < next))
+                    {
+                        next = hot_level;
+                    }
+                }
+                return next;
+            }
+
+            std::int64_t get_best_value()
+            {
+                return hot[0] * direction;
+            }
+
+            std::int64_t get_max_value()
+            {
+                return (direction < 0) ? get_best_value() : get_worst_value();
+            }
+
+            std::int64_t get_min_value()
+            {
+                return (direction < 0) ? get_worst_value() : get_best_value();
+            }
+
+            bool is_empty()
+            {
+                return n_hot == 0;
+            }
+
+            std::int64_t get_n_hot_levels()
+            {
+                return n_hot;
+            }
+
+            std::int64_t get_n_live_levels()
+            {
+                return n_live_levels.get();
+            }
+
+            orderbook::trees::avl_tree* get_cold_tree()
+            {
+                return cold;
+            }
+
+            orderbook::tick_level* get_memory_pool()
+            {
+                return cold->get_memory_pool();
+            }
+
+            orderbook::pools::object_pool<orderbook::tick_level>* get_node_pool()
+            {
+                // Only levels beyond the hot array hold a tree node.
+                return cold->get_node_pool();
+            }
+
+            ~price_ladder()
+            {
+                delete cold;
+            }
+    };
+}
@@ -0,0 +1,64 @@
+#define ORDERBOOK_ALLOCATION_HOOKS
+#include <gtest/gtest.h>
+#include <orderbook/testing/allocation_guard.h>
+#include <orderbook/orderbook/orderbook.h>
+
+orderbook::book* warmed_up_book() {
+    // Grow every queue used below past its burst size, then drain it, so the guarded section only reuses memory.
+    orderbook::book* ob = new orderbook::book{10};
+    for (std::int64_t i = 0; i < 30; i++) {
+        ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+        ob->add_to_book(4, order_side::BID, 1, order_type::ORDER_LIMIT);
+        ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    ob->add_to_book(6, order_side::BID, 60, order_type::ORDER_MARKET);
+    ob->add_to_book(4, order_side::ASK, 30, order_type::ORDER_MARKET);
+    return ob;
+}
+
+TEST(allocation_guard_test, test_detects_allocation) {
+    orderbook::testing::allocation_guard guard{};
+    std::int64_t* value = new std::int64_t{5};
+    EXPECT_EQ(guard.get_allocations(), 1);
+    delete value;
+};
+
+TEST(allocation_guard_test, test_ignores_unguarded_allocation) {
+    std::int64_t* value = new std::int64_t{5};
+    orderbook::testing::allocation_guard guard{};
+    EXPECT_EQ(guard.get_allocations(), 0);
+    delete value;
+};
+
+TEST(allocation_guard_test, test_add_to_book_allocation_free) {
+    orderbook::book* ob = warmed_up_book();
+    orderbook::testing::allocation_guard guard{};
+    for (std::int64_t i = 0; i < 20; i++) {
+        ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    EXPECT_EQ(guard.get_allocations(), 0);
+};
+
+TEST(allocation_guard_test, test_match_orders_allocation_free) {
+    orderbook::book* ob = warmed_up_book();
+    for (std::int64_t i = 0; i < 20; i++) {
+        ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    orderbook::testing::allocation_guard guard{};
+    ob->add_to_book(6, order_side::BID, 25, order_type::ORDER_LIMIT);
+    ob->match_orders();
+    EXPECT_EQ(guard.get_allocations(), 0);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 5);
+};
+
+TEST(allocation_guard_test, test_execute_market_order_allocation_free) {
+    orderbook::book* ob = warmed_up_book();
+    for (std::int64_t i = 0; i < 20; i++) {
+        ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+        ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    orderbook::testing::allocation_guard guard{};
+    ob->add_to_book(6, order_side::BID, 30, order_type::ORDER_MARKET);
+    EXPECT_EQ(guard.get_allocations(), 0);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(6), 10);
+};
@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <cstdlib>
+#include <set>
 #include <orderbook/trees/avl_tree.h>
 
 TEST(avl_tree_test, test_is_emtpy) {
@@ -98,4 +100,89 @@ TEST(avl_tree_test, test_contains_two) {
     tree->remove_min();
     tree->remove_max();
     EXPECT_EQ(tree->contains(1), false);
-};
\ No newline at end of file
+};
+TEST(avl_tree_test, test_insert_every_level) {
+    orderbook::trees::avl_tree* tree = new orderbook::trees::avl_tree{130};
+    for (std::int64_t i = 0; i < 130; i++) {
+        EXPECT_EQ(tree->insert(i), true);
+    }
+    EXPECT_EQ(tree->get_min_value(), 0);
+    EXPECT_EQ(tree->get_max_value(), 129);
+    EXPECT_EQ(tree->contains(117), true);
+    EXPECT_EQ(tree->find_next_level(129), 129);
+    tree->remove(129);
+    EXPECT_EQ(tree->find_next_level(129), -1);
+};
+
+TEST(avl_tree_test, test_contains_after_removing_inner_node) {
+    orderbook::trees::avl_tree* tree = new orderbook::trees::avl_tree{10};
+    tree->insert(2);
+    tree->insert(1);
+    tree->insert(3);
+    tree->remove(2);
+    EXPECT_EQ(tree->contains(2), false);
+    EXPECT_EQ(tree->contains(3), true);
+    tree->insert(2);
+    EXPECT_EQ(tree->get_n_live_levels(), 3);
+};
+
+TEST(avl_tree_test, test_node_is_sixteen_bytes) {
+    EXPECT_EQ(sizeof(orderbook::tick_level), 16);
+};
+
+TEST(avl_tree_test, test_stays_balanced) {
+    orderbook::trees::avl_tree* tree = new orderbook::trees::avl_tree{1024};
+    for (std::int64_t i = 0; i < 1023; i++) {
+        tree->insert(i);
+    }
+    EXPECT_EQ(tree->get_height(), 10);
+    for (std::int64_t i = 0; i < 1023; i += 2) {
+        tree->remove(i);
+    }
+    EXPECT_EQ(tree->get_n_live_levels(), 511);
+    EXPECT_LE(tree->get_height(), 13);
+    EXPECT_EQ(tree->get_min_value(), 1);
+    EXPECT_EQ(tree->get_max_value(), 1021);
+};
+
+TEST(avl_tree_test, test_matches_ordered_set) {
+    std::srand(11);
+    orderbook::trees::avl_tree* tree = new orderbook::trees::avl_tree{256};
+    std::set<std::int64_t> levels;
+    for (std::int64_t i = 0; i < 20000; i++) {
+        std::int64_t tick_level = std::rand() % 256;
+        if (std::rand() % 2) {
+            tree->insert(tick_level);
+            levels.insert(tick_level);
+        } else {
+            tree->remove(tick_level);
+            levels.erase(tick_level);
+        }
+        ASSERT_EQ(tree->get_n_live_levels(), static_cast<std::int64_t>(levels.size()));
+        ASSERT_EQ(tree->contains(tick_level), levels.count(tick_level) == 1);
+        if (!levels.empty()) {
+            ASSERT_EQ(tree->get_min_value(), *levels.begin());
+            ASSERT_EQ(tree->get_max_value(), *levels.rbegin());
+            ASSERT_LE(tree->get_height(), 12);
+        }
+    }
+};
+
+TEST(avl_tree_test, test_bulk_load_balanced) {
+    orderbook::trees::avl_tree* tree = new orderbook::trees::avl_tree{200};
+    std::int64_t tick_levels[100];
+    for (std::int64_t i = 0; i < 100; i++) {
+        tick_levels[i] = 2 * i;
+    }
+    EXPECT_EQ(tree->bulk_load(tick_levels, 100), true);
+    EXPECT_EQ(tree->get_height(), 7);
+    EXPECT_EQ(tree->get_n_live_levels(), 100);
+    EXPECT_EQ(tree->get_min_value(), 0);
+    EXPECT_EQ(tree->get_max_value(), 198);
+    EXPECT_EQ(tree->contains(50), true);
+    EXPECT_EQ(tree->contains(51), false);
+    tree->insert(51);
+    tree->remove(0);
+    EXPECT_EQ(tree->get_min_value(), 2);
+    EXPECT_EQ(tree->bulk_load(tick_levels, 100), false);
+};
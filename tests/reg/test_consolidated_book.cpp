@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook/consolidated_book.h>
+#include <orderbook/orderbook/orderbook.h>
+
+TEST(consolidated_book_test, test_best_from_level_events) {
+    orderbook::consolidated_book* consolidator = new orderbook::consolidated_book{3, 100};
+    EXPECT_EQ(consolidator->get_best_bid(), -1);
+    consolidator->apply(0, {order_side::BID, 40, 5});
+    consolidator->apply(1, {order_side::BID, 42, 1});
+    consolidator->apply(2, {order_side::ASK, 45, 2});
+    consolidator->apply(0, {order_side::ASK, 44, 3});
+    EXPECT_EQ(consolidator->get_best_bid(), 42);
+    EXPECT_EQ(consolidator->get_best_venue(order_side::BID), 1);
+    EXPECT_EQ(consolidator->get_best_ask(), 44);
+    consolidator->apply(1, {order_side::BID, 42, 0});
+    EXPECT_EQ(consolidator->get_best_bid(), 40);
+    consolidator->apply(0, {order_side::ASK, 44, 0});
+    EXPECT_EQ(consolidator->get_best_ask(), 45);
+    EXPECT_EQ(consolidator->get_best_venue(order_side::ASK), 2);
+};
+
+TEST(consolidated_book_test, test_merged_depth) {
+    orderbook::consolidated_book* consolidator = new orderbook::consolidated_book{3, 100, 4};
+    consolidator->apply(0, {order_side::ASK, 50, 1});
+    consolidator->apply(0, {order_side::ASK, 52, 2});
+    consolidator->apply(1, {order_side::ASK, 51, 3});
+    consolidator->apply(1, {order_side::ASK, 52, 4});
+    consolidator->apply(2, {order_side::ASK, 52, 5});
+    consolidator->apply(2, {order_side::ASK, 60, 6});
+    consolidator->apply(2, {order_side::ASK, 61, 7});
+    orderbook::maps::price_level depth[10];
+    EXPECT_EQ(consolidator->get_depth(order_side::ASK, 10, depth), 4);
+    EXPECT_EQ(depth[0].tick_level, 50);
+    EXPECT_EQ(depth[1].tick_level, 51);
+    EXPECT_EQ(depth[2].tick_level, 52);
+    EXPECT_EQ(depth[2].volume, 11);
+    EXPECT_EQ(depth[2].n_orders, 3);
+    EXPECT_EQ(depth[3].tick_level, 60);
+    EXPECT_EQ(consolidator->get_total_volume_at_tick_level(order_side::ASK, 52), 11);
+    EXPECT_EQ(consolidator->get_depth(order_side::BID, 10, depth), 0);
+};
+
+TEST(consolidated_book_test, test_attached_books) {
+    orderbook::consolidated_book* consolidator = new orderbook::consolidated_book{2, 100};
+    orderbook::book* venue_a = new orderbook::book{100};
+    orderbook::book* venue_b = new orderbook::book{100};
+    consolidator->attach(venue_a, 0);
+    consolidator->attach(venue_b, 1);
+    venue_a->add_to_book(40, order_side::BID, 5, order_type::ORDER_LIMIT);
+    venue_a->add_to_book(45, order_side::ASK, 5, order_type::ORDER_LIMIT);
+    venue_b->add_to_book(41, order_side::BID, 2, order_type::ORDER_LIMIT);
+    venue_b->add_to_book(44, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    EXPECT_EQ(consolidator->get_best_bid(), 41);
+    EXPECT_EQ(consolidator->get_best_ask(), 44);
+    venue_b->add_to_book(41, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(consolidator->get_best_bid(), 40);
+    venue_b->add_to_book(44, order_side::BID, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(consolidator->get_total_volume_at_tick_level(order_side::ASK, 44), 2);
+    EXPECT_EQ(venue_b->cancel_all(order_side::ASK), 1);
+    EXPECT_EQ(consolidator->get_best_ask(), 45);
+    venue_a->cancel_order(0);
+    EXPECT_EQ(consolidator->get_best_bid(), -1);
+};
+
+TEST(consolidated_book_test, test_reduce_in_place_modify) {
+    orderbook::consolidated_book* consolidator = new orderbook::consolidated_book{1, 100};
+    orderbook::book* venue = new orderbook::book{100};
+    consolidator->attach(venue, 0);
+    venue->add_to_book(5, order_side::BID, 10, order_type::ORDER_LIMIT);
+    EXPECT_EQ(consolidator->get_total_volume_at_tick_level(order_side::BID, 5), 10);
+    EXPECT_EQ(venue->modify_order(0, 4, 5), true);
+    EXPECT_EQ(consolidator->get_total_volume_at_tick_level(order_side::BID, 5), 4);
+    EXPECT_EQ(consolidator->get_best_bid(), 5);
+};
+
+TEST(consolidated_book_test, test_attach_loads_resting_levels) {
+    orderbook::consolidated_book* consolidator = new orderbook::consolidated_book{2, 100};
+    orderbook::book* venue = new orderbook::book{100};
+    venue->add_to_book(5, order_side::BID, 3, order_type::ORDER_LIMIT);
+    venue->add_to_book(4, order_side::BID, 2, order_type::ORDER_LIMIT);
+    venue->add_to_book(9, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    consolidator->attach(venue, 1);
+    EXPECT_EQ(consolidator->get_best_bid(), 5);
+    EXPECT_EQ(consolidator->get_best_ask(), 9);
+    EXPECT_EQ(consolidator->get_best_venue(order_side::BID), 1);
+    EXPECT_EQ(consolidator->get_total_volume_at_tick_level(order_side::BID, 4), 2);
+    venue->cancel_order(0);
+    EXPECT_EQ(consolidator->get_best_bid(), 4);
+};
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <orderbook/telemetry/counter.h>
+
+TEST(counter_test, test_increment_decrement) {
+    orderbook::telemetry::counter* counter = new orderbook::telemetry::counter{};
+    counter->increment();
+    counter->increment();
+    counter->decrement();
+    EXPECT_EQ(counter->get(), 1);
+};
+
+TEST(counter_test, test_set_max) {
+    orderbook::telemetry::counter* counter = new orderbook::telemetry::counter{};
+    counter->set_max(5);
+    counter->set_max(3);
+    EXPECT_EQ(counter->get(), 5);
+};
+
+TEST(counter_test, test_read_from_other_thread) {
+    orderbook::telemetry::counter* counter = new orderbook::telemetry::counter{};
+    std::thread writer([counter]() {
+        for (std::int64_t i = 0; i < 100000; i++) {
+            counter->increment();
+        }
+    });
+    writer.join();
+    std::int64_t value = 0;
+    std::thread reader([counter, &value]() { value = counter->get(); });
+    reader.join();
+    EXPECT_EQ(value, 100000);
+};
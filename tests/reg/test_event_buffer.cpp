@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <orderbook/events/event_buffer.h>
+
+struct captured_fills {
+    std::int64_t batches = 0;
+    std::int64_t events = 0;
+    std::int64_t volume = 0;
+};
+
+void capture_fills(const orderbook::events::fill_event* events, std::int64_t n_events, void* context) {
+    captured_fills* captured = static_cast<captured_fills*>(context);
+    captured->batches++;
+    captured->events += n_events;
+    for (std::int64_t i = 0; i < n_events; i++) {
+        captured->volume += events[i].size;
+    }
+}
+
+TEST(event_buffer_test, test_flush_publishes_batch) {
+    captured_fills captured;
+    orderbook::events::event_buffer<orderbook::events::fill_event>* buffer =
+        new orderbook::events::event_buffer<orderbook::events::fill_event>{8, capture_fills, &captured};
+    buffer->push({1, 0, 5, 3});
+    buffer->push({1, 2, 5, 4});
+    EXPECT_EQ(captured.batches, 0);
+    buffer->flush();
+    EXPECT_EQ(captured.batches, 1);
+    EXPECT_EQ(captured.events, 2);
+    EXPECT_EQ(captured.volume, 7);
+    EXPECT_EQ(buffer->get_size(), 0);
+};
+
+TEST(event_buffer_test, test_flush_when_full) {
+    captured_fills captured;
+    orderbook::events::event_buffer<orderbook::events::fill_event>* buffer =
+        new orderbook::events::event_buffer<orderbook::events::fill_event>{4, capture_fills, &captured};
+    for (std::int64_t i = 0; i < 5; i++) {
+        buffer->push({1, i, 5, 1});
+    }
+    EXPECT_EQ(captured.batches, 1);
+    EXPECT_EQ(captured.events, 4);
+    EXPECT_EQ(buffer->get_size(), 1);
+};
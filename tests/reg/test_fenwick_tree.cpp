@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include <orderbook/trees/fenwick_tree.h>
+
+TEST(fenwick_tree_test, test_prefix_sum) {
+    orderbook::trees::fenwick_tree* tree = new orderbook::trees::fenwick_tree{100};
+    tree->add(3, 5);
+    tree->add(10, 7);
+    tree->add(99, 1);
+    EXPECT_EQ(tree->prefix_sum(2), 0);
+    EXPECT_EQ(tree->prefix_sum(3), 5);
+    EXPECT_EQ(tree->prefix_sum(50), 12);
+    EXPECT_EQ(tree->prefix_sum(99), 13);
+    EXPECT_EQ(tree->get_total(), 13);
+};
+
+TEST(fenwick_tree_test, test_suffix_sum) {
+    orderbook::trees::fenwick_tree* tree = new orderbook::trees::fenwick_tree{100};
+    tree->add(0, 2);
+    tree->add(10, 7);
+    tree->add(99, 1);
+    EXPECT_EQ(tree->suffix_sum(0), 10);
+    EXPECT_EQ(tree->suffix_sum(1), 8);
+    EXPECT_EQ(tree->suffix_sum(11), 1);
+};
+
+TEST(fenwick_tree_test, test_remove_volume) {
+    orderbook::trees::fenwick_tree* tree = new orderbook::trees::fenwick_tree{100};
+    tree->add(10, 7);
+    tree->add(10, -3);
+    EXPECT_EQ(tree->prefix_sum(10), 4);
+    tree->add(10, -4);
+    EXPECT_EQ(tree->get_total(), 0);
+};
@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <orderbook/trees/indexed_heap.h>
+
+TEST(indexed_heap_test, test_update) {
+    orderbook::trees::indexed_heap* heap = new orderbook::trees::indexed_heap{4, 100};
+    heap->update(2, 5);
+    heap->update(0, 7);
+    EXPECT_EQ(heap->get_top(), 2);
+    heap->update(2, 9);
+    EXPECT_EQ(heap->get_top(), 0);
+    EXPECT_EQ(heap->get_top_key(), 7);
+    heap->update(3, 1);
+    EXPECT_EQ(heap->get_top(), 3);
+    EXPECT_EQ(heap->get_key(2), 9);
+};
+
+TEST(indexed_heap_test, test_random_updates) {
+    std::int64_t keys[32];
+    orderbook::trees::indexed_heap* heap = new orderbook::trees::indexed_heap{32, 0};
+    std::fill(keys, keys + 32, 0);
+    std::mt19937_64 rng{7};
+    for (std::int64_t i = 0; i < 2000; i++) {
+        std::int64_t item = rng() % 32;
+        keys[item] = rng() % 1000;
+        heap->update(item, keys[item]);
+        EXPECT_EQ(heap->get_top_key(), *std::min_element(keys, keys + 32));
+        EXPECT_EQ(keys[heap->get_top()], heap->get_top_key());
+    }
+};
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <orderbook/maps/level_map.h>
+
+TEST(level_map_test, test_best_bid_follows_levels) {
+    orderbook::maps::level_map* bids = new orderbook::maps::level_map{100, order_side::BID};
+    EXPECT_EQ(bids->is_empty(), true);
+    bids->set_level(40, 10, 2);
+    bids->set_level(42, 5, 1);
+    bids->set_level(30, 7, 3);
+    EXPECT_EQ(bids->get_best(), 42);
+    bids->set_level(42, 0, 0);
+    EXPECT_EQ(bids->get_best(), 40);
+    EXPECT_EQ(bids->get_n_levels(), 2);
+    bids->set_level(40, 0, 0);
+    bids->set_level(30, 0, 0);
+    EXPECT_EQ(bids->is_empty(), true);
+    delete bids;
+};
+
+TEST(level_map_test, test_deltas) {
+    orderbook::maps::level_map* asks = new orderbook::maps::level_map{100, order_side::ASK};
+    asks->add_to_level(50, 4, 1);
+    asks->add_to_level(50, 6, 1);
+    EXPECT_EQ(asks->get_total_volume_at_tick_level(50), 10);
+    EXPECT_EQ(asks->get_order_count_at_tick_level(50), 2);
+    asks->add_to_level(50, -10, -2);
+    EXPECT_EQ(asks->is_empty(), true);
+    EXPECT_EQ(asks->get_order_count_at_tick_level(50), 0);
+    delete asks;
+};
+
+TEST(level_map_test, test_depth) {
+    orderbook::maps::level_map* asks = new orderbook::maps::level_map{200, order_side::ASK};
+    asks->set_level(199, 1, 1);
+    asks->set_level(60, 2, 1);
+    asks->set_level(130, 3, 2);
+    orderbook::maps::price_level depth[4];
+    EXPECT_EQ(asks->get_depth(4, depth), 3);
+    EXPECT_EQ(depth[0].tick_level, 60);
+    EXPECT_EQ(depth[1].tick_level, 130);
+    EXPECT_EQ(depth[1].n_orders, 2);
+    EXPECT_EQ(depth[2].tick_level, 199);
+    EXPECT_EQ(asks->get_depth(2, depth), 2);
+    delete asks;
+};
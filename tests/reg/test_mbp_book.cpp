@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook/mbp_book.h>
+
+TEST(mbp_book_test, test_best_prices) {
+    orderbook::mbp_book* ob = new orderbook::mbp_book{1000};
+    ob->set_level(order_side::BID, 499, 10, 3);
+    ob->set_level(order_side::BID, 498, 20, 4);
+    ob->set_level(order_side::ASK, 501, 15, 2);
+    EXPECT_EQ(ob->get_best_bid(), 499);
+    EXPECT_EQ(ob->get_best_ask(), 501);
+    EXPECT_EQ(ob->get_total_volume_at_tick_level(order_side::BID, 498), 20);
+    EXPECT_EQ(ob->get_order_count_at_tick_level(order_side::ASK, 501), 2);
+    ob->set_level(order_side::BID, 499, 0, 0);
+    EXPECT_EQ(ob->get_best_bid(), 498);
+    delete ob;
+};
+
+TEST(mbp_book_test, test_out_of_bounds_dropped) {
+    orderbook::mbp_book* ob = new orderbook::mbp_book{10};
+    EXPECT_EQ(ob->set_level(order_side::ASK, 10, 1, 1), false);
+    EXPECT_EQ(ob->add_to_level(order_side::ASK, -1, 1, 1), false);
+    EXPECT_EQ(ob->get_best_ask(), -1);
+    delete ob;
+};
+
+TEST(mbp_book_test, test_depth) {
+    orderbook::mbp_book* ob = new orderbook::mbp_book{100};
+    for (std::int64_t tick_level = 10; tick_level < 20; tick_level += 2) {
+        ob->add_to_level(order_side::BID, tick_level, tick_level, 1);
+    }
+    orderbook::maps::price_level depth[3];
+    EXPECT_EQ(ob->get_depth(order_side::BID, 3, depth), 3);
+    EXPECT_EQ(depth[0].tick_level, 18);
+    EXPECT_EQ(depth[2].tick_level, 14);
+    EXPECT_EQ(depth[2].volume, 14);
+    delete ob;
+};
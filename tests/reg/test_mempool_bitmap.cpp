@@ -37,3 +37,33 @@ TEST(mempool_bitmap_test, test_aquire_release_four) {
     bitmap->aquire();
     EXPECT_EQ(bitmap->aquire(),2);
 };
+
+TEST(mempool_bitmap_test, test_aquire_exhausted) {
+    orderbook::bitmaps::mempool_bitmap* bitmap = new orderbook::bitmaps::mempool_bitmap{3};
+    bitmap->aquire();
+    bitmap->aquire();
+    bitmap->aquire();
+    EXPECT_EQ(bitmap->aquire(),-1);
+    bitmap->release(1);
+    EXPECT_EQ(bitmap->aquire(),1);
+};
+
+TEST(mempool_bitmap_test, test_aquire_release_large) {
+    orderbook::bitmaps::mempool_bitmap* bitmap = new orderbook::bitmaps::mempool_bitmap{4000000};
+    for (std::int64_t i = 0; i < 300000; i++) {
+        bitmap->aquire();
+    }
+    bitmap->release(262143);
+    bitmap->release(4096);
+    EXPECT_EQ(bitmap->aquire(),4096);
+    EXPECT_EQ(bitmap->aquire(),262143);
+    EXPECT_EQ(bitmap->aquire(),300000);
+};
+
+TEST(mempool_bitmap_test, test_is_free) {
+    orderbook::bitmaps::mempool_bitmap* bitmap = new orderbook::bitmaps::mempool_bitmap{100};
+    bitmap->aquire();
+    EXPECT_EQ(bitmap->is_free(0),false);
+    EXPECT_EQ(bitmap->is_free(99),true);
+    EXPECT_EQ(bitmap->get_capacity(),100);
+};
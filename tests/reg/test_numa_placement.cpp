@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <cctype>
+#include <orderbook/numa/placement.h>
+
+static std::int64_t n_numa_nodes() {
+    // sysfs lists each node as /sys/devices/system/node/nodeN, the directory is missing without NUMA support.
+    std::int64_t n = 0;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() > 4 && name.compare(0, 4, "node") == 0 && std::isdigit(static_cast<unsigned char>(name[4]))) {
+            n++;
+        }
+    }
+    return n;
+}
+
+TEST(numa_placement_test, test_node_of_cpu) {
+    EXPECT_GE(orderbook::numa::book_placement::node_of_cpu(0), 0);
+};
+
+TEST(numa_placement_test, test_make_book) {
+    orderbook::numa::book_placement* placement = new orderbook::numa::book_placement{0};
+    orderbook::book* ob = placement->make_book(10);
+    ob->add_to_book(5, order_side::ASK, 5, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 5);
+};
+
+TEST(numa_placement_test, test_report_one) {
+    orderbook::numa::book_placement* placement = new orderbook::numa::book_placement{0};
+    orderbook::book* ob = placement->make_book(10);
+    orderbook::numa::memory_placement placements[orderbook::numa::book_placement::N_COMPONENTS];
+    placement->report(ob, placements);
+    EXPECT_EQ(placements[0].regions, 1);
+    EXPECT_EQ(placements[4].regions, 10);
+    EXPECT_EQ(placements[5].regions, 10);
+};
+
+TEST(numa_placement_test, test_report_two) {
+    if (n_numa_nodes() <= 1) {
+        GTEST_SKIP() << "placement is only observable with more than one NUMA node";
+    }
+    orderbook::numa::book_placement* placement = new orderbook::numa::book_placement{0};
+    orderbook::book* ob = placement->make_book(10);
+    orderbook::numa::memory_placement placements[orderbook::numa::book_placement::N_COMPONENTS];
+    placement->report(ob, placements);
+    for (std::int64_t i = 0; i < orderbook::numa::book_placement::N_COMPONENTS; i++) {
+        EXPECT_EQ(placements[i].regions_on_node, placements[i].regions);
+    }
+};
+
+TEST(numa_placement_test, test_grower_off_matching_cpu) {
+    if (std::thread::hardware_concurrency() <= 1) {
+        GTEST_SKIP() << "the grower can only leave the matching cpu with more than one cpu";
+    }
+    orderbook::numa::book_placement* placement = new orderbook::numa::book_placement{0};
+    orderbook::book* ob = placement->make_book(10);
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    EXPECT_EQ(pthread_getaffinity_np(ob->grower->get_native_handle(), sizeof(cpu_set), &cpu_set), 0);
+    EXPECT_FALSE(CPU_ISSET(0, &cpu_set));
+    EXPECT_GT(CPU_COUNT(&cpu_set), 0);
+};
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include <orderbook/pools/object_pool.h>
+
+struct pooled_object {
+    std::int64_t value;
+};
+
+TEST(object_pool_test, test_aquire_one) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{4, pooled_object{-1}};
+    pooled_object* object = pool->aquire();
+    EXPECT_EQ(object->value, -1);
+    EXPECT_EQ(pool->index_of(object), 0);
+    EXPECT_EQ(pool->get_in_use(), 1);
+};
+
+TEST(object_pool_test, test_aquire_grows) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{2, pooled_object{-1}};
+    pooled_object* one = pool->aquire();
+    one->value = 5;
+    pool->aquire();
+    EXPECT_NE(pool->aquire(), nullptr);
+    EXPECT_EQ(pool->get_capacity(), 4);
+    EXPECT_EQ(pool->get_n_chunks(), 2);
+    EXPECT_EQ(one->value, 5);
+};
+
+TEST(object_pool_test, test_aquire_grows_from_grower) {
+    orderbook::pools::pool_grower* grower = new orderbook::pools::pool_grower{};
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{4, pooled_object{-1}, grower};
+    for (std::int64_t i = 0; i < 100; i++) {
+        EXPECT_NE(pool->aquire(), nullptr);
+    }
+    EXPECT_EQ(pool->get_in_use(), 100);
+    EXPECT_EQ(pool->index_of(pool->at(99)), 99);
+    delete grower;
+    delete pool;
+};
+
+TEST(object_pool_test, test_aquire_grows_chunk_table) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{1, pooled_object{-1}};
+    pooled_object* first = pool->aquire();
+    first->value = 7;
+    for (std::int64_t i = 1; i < 100; i++) {
+        EXPECT_NE(pool->aquire(), nullptr);
+    }
+    EXPECT_EQ(pool->get_n_chunks(), 100);
+    EXPECT_EQ(pool->index_of(first), 0);
+    EXPECT_EQ(first->value, 7);
+    pool->release(pool->at(50));
+    EXPECT_EQ(pool->aquire(), pool->at(50));
+};
+
+TEST(object_pool_test, test_aquire_handle_maximum_capacity) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{1, pooled_object{-1}};
+    for (std::int64_t i = 0; i < orderbook::pools::object_pool<pooled_object>::MAX_HANDLE_CHUNKS; i++) {
+        EXPECT_NE(pool->aquire_handle(), orderbook::pools::object_pool<pooled_object>::NO_HANDLE);
+    }
+    EXPECT_EQ(pool->aquire_handle(), orderbook::pools::object_pool<pooled_object>::NO_HANDLE);
+    EXPECT_NE(pool->aquire(), nullptr);
+};
+
+TEST(object_pool_test, test_aquire_release) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{4, pooled_object{-1}};
+    pooled_object* one = pool->aquire();
+    pool->aquire();
+    pool->release(one);
+    EXPECT_EQ(pool->get_in_use(), 1);
+    EXPECT_EQ(pool->aquire(), one);
+};
+
+TEST(object_pool_test, test_at) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{4, pooled_object{-1}};
+    pool->aquire()->value = 7;
+    EXPECT_EQ(pool->at(0)->value, 7);
+    EXPECT_EQ(pool->get_capacity(), 4);
+};
+
+TEST(object_pool_test, test_handles_across_chunks) {
+    orderbook::pools::object_pool<pooled_object>* pool = new orderbook::pools::object_pool<pooled_object>{4, pooled_object{-1}};
+    std::uint32_t handles[6];
+    for (std::int64_t i = 0; i < 6; i++) {
+        handles[i] = pool->aquire_handle();
+        pool->from_handle(handles[i])->value = i;
+    }
+    EXPECT_EQ(handles[5] >> orderbook::pools::object_pool<pooled_object>::HANDLE_SHIFT, 1);
+    EXPECT_EQ(pool->from_handle(handles[5]), pool->at(5));
+    pool->release_handle(handles[2]);
+    EXPECT_EQ(pool->get_in_use(), 5);
+    EXPECT_EQ(pool->aquire_handle(), handles[2]);
+};
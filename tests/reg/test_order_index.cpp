@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include <orderbook/maps/order_index.h>
+
+TEST(order_index_test, test_set_get) {
+    orderbook::maps::order_index* index = new orderbook::maps::order_index{};
+    index->set(7, 1, 42, 3);
+    const orderbook::maps::order_location* location = index->get(7);
+    ASSERT_NE(location, nullptr);
+    EXPECT_EQ(location->order_side, 1);
+    EXPECT_EQ(location->tick_level, 42);
+    EXPECT_EQ(location->sequence, 3);
+    EXPECT_EQ(index->get(8), nullptr);
+};
+
+TEST(order_index_test, test_grows_with_ids) {
+    orderbook::maps::order_index* index = new orderbook::maps::order_index{};
+    index->set(100000, -1, 5, 0);
+    EXPECT_GT(index->get_n_chunks(), 1);
+    EXPECT_EQ(index->get(100000)->tick_level, 5);
+    EXPECT_EQ(index->get(-1), nullptr);
+};
+
+TEST(order_index_test, test_owner_kept_across_moves) {
+    orderbook::maps::order_index* index = new orderbook::maps::order_index{};
+    index->set_owner(3, 11);
+    index->set(3, 1, 42, 0);
+    index->set(3, 1, 40, 5);
+    EXPECT_EQ(index->get(3)->owner, 11);
+    EXPECT_EQ(index->get(3)->tick_level, 40);
+    index->set(4, 1, 42, 1);
+    EXPECT_EQ(index->get(4)->owner, -1);
+};
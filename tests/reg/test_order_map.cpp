@@ -1,4 +1,6 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
 #include <orderbook/maps/order_map.h>
 
 TEST(order_map_test, test_enqueue_dequeue) {
@@ -60,4 +62,118 @@ TEST(order_map_test, test_get_total_volume_at_tick_level_two) {
     order_map->add_order(4, 4, -1, 55, 1, -1);
     order_map->partial_fill_priority(5, 50);
     EXPECT_EQ(order_map->get_total_volume_at_tick_level(5), 150);
-};
\ No newline at end of file
+};
+TEST(order_map_test, test_resting_orders) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    order_map->add_order(1, 5, 1, 88, 1, -1);
+    order_map->add_order(2, 5, 1, 99, 1, -1);
+    order_map->add_order(3, 4, 1, 77, 1, -1);
+    order_map->remove_priority_order(5);
+    order_map->remove_priority_order(6);
+    EXPECT_EQ(order_map->get_resting_orders(), 2);
+};
+
+TEST(order_map_test, test_depth_high_water_mark) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    order_map->add_order(1, 5, 1, 88, 1, -1);
+    order_map->add_order(2, 5, 1, 99, 1, -1);
+    order_map->add_order(3, 5, 1, 77, 1, -1);
+    order_map->remove_priority_order(5);
+    order_map->remove_priority_order(5);
+    order_map->add_order(4, 5, 1, 77, 1, -1);
+    EXPECT_EQ(order_map->get_depth_high_water_mark(5), 3);
+    EXPECT_EQ(order_map->get_depth_high_water_mark(4), 0);
+};
+
+TEST(order_map_test, test_queue_growths) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    for (std::int64_t i = 0; i < 11; i++) {
+        order_map->add_order(i, 5, 1, 1, 1, -1);
+    }
+    EXPECT_EQ(order_map->get_queue_growths(), 1);
+    EXPECT_EQ(order_map->get_queue_growths_on_matching_thread(), 1);
+};
+
+TEST(order_map_test, test_queue_growths_from_grower) {
+    // A paced burst leaves the grower time to prepare each chunk, so no growth falls back to the matching thread.
+    orderbook::pools::pool_grower* grower = new orderbook::pools::pool_grower{};
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10, grower};
+    for (std::int64_t i = 0; i < 100; i++) {
+        order_map->add_order(i, 5, 1, 1, 1, -1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    EXPECT_EQ(order_map->get_queue_growths(), 9);
+    EXPECT_EQ(order_map->get_queue_growths_on_matching_thread(), 0);
+    delete grower;
+    delete order_map;
+};
+
+TEST(order_map_test, test_iceberg_levels_flagged) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    order_map->add_order(1, 5, 1, 4, order_type::ORDER_LIMIT, -1);
+    EXPECT_FALSE(order_map->has_icebergs(5));
+    std::int64_t sequence = order_map->add_iceberg_order(2, 5, 1, 10, 2);
+    EXPECT_TRUE(order_map->has_icebergs(5));
+    EXPECT_FALSE(order_map->has_icebergs(4));
+    order_map->remove_priority_order(5);
+    EXPECT_TRUE(order_map->has_icebergs(5));
+    order_map->remove_order(5, sequence);
+    EXPECT_FALSE(order_map->has_icebergs(5));
+};
+
+TEST(order_map_test, test_plain_fill_skips_reserve_check) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    order_map->add_order(1, 5, 1, 3, order_type::ORDER_LIMIT, -1);
+    order_map->add_order(2, 5, 1, 4, order_type::ORDER_LIMIT, -1);
+    std::int64_t n_filled = 0;
+    EXPECT_EQ(order_map->fill_priority_orders<false>(5, 10, [&](orderbook::order*) { n_filled++; }), 7);
+    EXPECT_EQ(n_filled, 2);
+    EXPECT_TRUE(order_map->is_empty(5));
+    EXPECT_EQ(order_map->get_volume_at_or_above(0), 0);
+};
+
+TEST(order_map_test, test_add_orders_bulk) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    std::int64_t sequence = order_map->add_orders(5, 3, [](std::int64_t k, orderbook::order* order) {
+        order->set_order_attributes(k, k + 1, 1, order_type::ORDER_LIMIT, -1);
+    });
+    EXPECT_EQ(sequence, 0);
+    EXPECT_EQ(order_map->get_total_volume_at_tick_level(5), 6);
+    EXPECT_EQ(order_map->get_volume_at_or_above(5), 6);
+    EXPECT_EQ(order_map->get_resting_orders(), 3);
+    EXPECT_EQ(order_map->get_priority_order(5)->get_order_id(), 0);
+};
+
+TEST(order_map_test, test_clear_level) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    order_map->add_order(0, 5, 1, 2, order_type::ORDER_LIMIT, -1);
+    std::int64_t sequence = order_map->add_order(1, 5, 1, 3, order_type::ORDER_LIMIT, -1);
+    order_map->add_iceberg_order(2, 5, 1, 10, 4);
+    order_map->add_order(3, 6, 1, 1, order_type::ORDER_LIMIT, -1);
+    order_map->cancel_order(1, 5, sequence);
+    orderbook::queues::batch_fill cleared = order_map->clear_level(5);
+    EXPECT_EQ(cleared.orders, 2);
+    EXPECT_EQ(cleared.volume, 6);
+    EXPECT_TRUE(order_map->is_empty(5));
+    EXPECT_FALSE(order_map->has_icebergs(5));
+    EXPECT_EQ(order_map->get_resting_orders(), 1);
+    EXPECT_EQ(order_map->get_volume_at_or_above(0), 1);
+    EXPECT_EQ(order_map->cancel_order(0, 5, 0), false);
+    EXPECT_EQ(order_map->add_order(4, 5, 1, 2, order_type::ORDER_LIMIT, -1), 3);
+};
+
+TEST(order_map_test, test_publish_level_changes) {
+    orderbook::maps::order_map* order_map = new orderbook::maps::order_map{10};
+    orderbook::events::event_buffer<orderbook::events::level_event>* events = new orderbook::events::event_buffer<orderbook::events::level_event>{16};
+    order_map->add_order(0, 5, 1, 2, order_type::ORDER_LIMIT, -1);
+    order_map->publish_level_changes(events, order_side::ASK);
+    std::int64_t sequence = order_map->add_order(1, 5, 1, 3, order_type::ORDER_LIMIT, -1);
+    order_map->partial_fill_priority(5, 1);
+    order_map->remove_order(5, sequence);
+    EXPECT_EQ(events->get_size(), 3);
+    order_map->fill_priority_orders(5, 0, [](orderbook::order*) {});
+    EXPECT_EQ(events->get_size(), 3);
+    order_map->publish_level_changes(nullptr, order_side::ASK);
+    order_map->remove_priority_order(5);
+    EXPECT_EQ(events->get_size(), 3);
+};
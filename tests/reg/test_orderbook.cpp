@@ -16,24 +16,27 @@ TEST(test_orderbook, test_bids_and_asks_exist_two) {
 
 TEST(test_orderbook, test_bids_and_asks_exist_three) {
     orderbook::book* ob = new orderbook::book{10};
-    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
     ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
     ob->bids_and_asks_exist();
     EXPECT_EQ(ob->bids_and_asks_exist(), true);
 };
 
 TEST(test_orderbook, test_can_match_orders_one) {
+    // Marketable limit orders match on arrival, so the book is never left crossed.
     orderbook::book* ob = new orderbook::book{10};
     ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
     ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
-    EXPECT_EQ(ob->can_match_orders(), true);
+    EXPECT_EQ(ob->can_match_orders(), false);
+    EXPECT_EQ(ob->bids_and_asks_exist(), false);
 };
 
 TEST(test_orderbook, test_can_match_orders_two) {
     orderbook::book* ob = new orderbook::book{10};
     ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
-    ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
-    EXPECT_EQ(ob->can_match_orders(), true);
+    ob->add_to_book(5, order_side::BID, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->can_match_orders(), false);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 1);
 };
 
 TEST(test_orderbook, test_can_match_orders_three) {
@@ -222,4 +225,623 @@ TEST(test_orderbook, test_match_orders_ten) {
     EXPECT_EQ(ob->ask_map->is_empty(5), true);
     EXPECT_EQ(ob->ask_map->is_empty(6), true);
     EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 0);
-};
\ No newline at end of file
+};
+TEST(test_orderbook, test_queue_growth) {
+    orderbook::book* ob = new orderbook::book{10};
+    for (std::int64_t i = 0; i < 25; i++) {
+        ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 25);
+    delete ob;
+};
+
+TEST(test_orderbook, test_stats_levels) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(2, order_side::BID, 1, order_type::ORDER_LIMIT);
+    orderbook::book_stats stats = ob->get_stats();
+    EXPECT_EQ(stats.ask_levels, 2);
+    EXPECT_EQ(stats.bid_levels, 1);
+    EXPECT_EQ(stats.ask_nodes_in_use, 0); // both levels are near the touch, only deeper levels use tree nodes.
+    EXPECT_EQ(stats.ask_node_capacity, 10);
+    EXPECT_EQ(stats.ask_resting_orders, 3);
+    EXPECT_EQ(stats.bid_resting_orders, 1);
+};
+
+TEST(test_orderbook, test_stats_after_match) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 5, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 5, order_type::ORDER_LIMIT);
+    ob->match_orders();
+    orderbook::book_stats stats = ob->get_stats();
+    EXPECT_EQ(stats.ask_levels, 0);
+    EXPECT_EQ(stats.bid_levels, 0);
+    EXPECT_EQ(stats.bid_nodes_in_use, 0);
+    EXPECT_EQ(stats.ask_resting_orders, 0);
+};
+
+TEST(test_orderbook, test_stats_dropped_orders) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(50, order_side::ASK, 5, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->get_stats().dropped_orders, 1);
+};
+
+TEST(test_orderbook, test_marketable_limit_order_one) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(7, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 10, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->is_empty(5), true);
+    EXPECT_EQ(ob->ask_map->is_empty(6), true);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(7), 3);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 4);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 7);
+};
+
+TEST(test_orderbook, test_marketable_limit_order_two) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::BID, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::ASK, 6, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->bid_map->is_empty(5), true);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(4), 2);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_marketable_limit_order_price_time) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_size(), 2);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_order_id(), 1);
+};
+
+TEST(test_orderbook, test_stop_not_visible_depth) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(6, order_side::BID, 5, order_type::ORDER_STOP_LIMIT, 7);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 0);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    EXPECT_EQ(ob->get_stats().bid_stop_orders, 1);
+};
+
+TEST(test_orderbook, test_buy_stop_triggered_by_trade) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(6, order_side::BID, 5, order_type::ORDER_STOP_LIMIT, 7);
+    ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(7, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    ob->add_to_book(6, order_side::BID, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->last_trade_price, 7);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(7), 3);
+    EXPECT_EQ(ob->get_stats().bid_stop_orders, 0);
+};
+
+TEST(test_orderbook, test_sell_stop_triggered_by_trade) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(4, order_side::ASK, 5, order_type::ORDER_STOP_LIMIT, 3);
+    ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->get_stats().ask_stop_orders, 1);
+    ob->add_to_book(4, order_side::BID, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::ASK, 1, order_type::ORDER_MARKET);
+    EXPECT_EQ(ob->get_stats().ask_stop_orders, 0);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(3), 5);
+};
+
+TEST(test_orderbook, test_stop_triggered_on_arrival) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::BID, 2, order_type::ORDER_STOP_LIMIT, 3);
+    EXPECT_EQ(ob->get_stats().bid_stop_orders, 0);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(3), 2);
+};
+
+TEST(test_orderbook, test_available_volume) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(8, order_side::ASK, 5, order_type::ORDER_LIMIT);
+    ob->add_to_book(3, order_side::BID, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->available_volume(order_side::BID, 4), 0);
+    EXPECT_EQ(ob->available_volume(order_side::BID, 6), 7);
+    EXPECT_EQ(ob->available_volume(order_side::BID, 9), 12);
+    EXPECT_EQ(ob->available_volume(order_side::ASK, 3), 2);
+    EXPECT_EQ(ob->available_volume(order_side::ASK, 4), 0);
+};
+
+TEST(test_orderbook, test_fill_or_kill_across_levels) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 6, order_type::ORDER_FILL_OR_KILL);
+    EXPECT_EQ(ob->ask_map->is_empty(5), true);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(6), 1);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    EXPECT_EQ(ob->available_volume(order_side::BID, 9), 1);
+};
+
+TEST(test_orderbook, test_fill_or_kill_killed) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::BID, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 4, order_type::ORDER_FILL_OR_KILL);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 3);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(4), 3);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->last_trade_price, -1);
+};
+
+TEST(test_orderbook, test_cancel_order) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 4, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->cancel_order(0), true);
+    EXPECT_EQ(ob->cancel_order(0), false);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 4);
+    EXPECT_EQ(ob->cancel_order(1), true);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    EXPECT_EQ(ob->available_volume(order_side::ASK, 0), 0);
+};
+
+TEST(test_orderbook, test_immediate_or_cancel) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(7, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 5, order_type::ORDER_IMMEDIATE_OR_CANCEL);
+    EXPECT_EQ(ob->ask_map->is_empty(5), true);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(7), 3);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_good_till_date_expires) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_GOOD_TILL_DATE, -1, -1, 100);
+    ob->add_to_book(4, order_side::BID, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->get_stats().pending_expiries, 1);
+    ob->advance_clock(99);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 3);
+    ob->advance_clock(100);
+    EXPECT_EQ(ob->bid_map->is_empty(5), true);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 4);
+    EXPECT_EQ(ob->get_stats().pending_expiries, 0);
+};
+
+TEST(test_orderbook, test_good_till_date_filled_before_expiry) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_GOOD_TILL_DATE, -1, -1, 100);
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
+    ob->advance_clock(200);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 1);
+};
+
+TEST(test_orderbook, test_good_till_date_expired_on_arrival) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->advance_clock(50);
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_GOOD_TILL_DATE, -1, -1, 50);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_add_orders_good_till_date_expired_on_arrival) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->advance_clock(100);
+    orderbook::command commands[3] = {
+        orderbook::command::add(5, order_side::BID, 3, order_type::ORDER_GOOD_TILL_DATE, -1, 50),
+        orderbook::command::add(4, order_side::BID, 2, order_type::ORDER_GOOD_TILL_DATE, -1, 150),
+        orderbook::command::add(5, order_side::ASK, 3, order_type::ORDER_LIMIT),
+    };
+    ob->add_orders(commands, 3);
+    EXPECT_EQ(ob->bid_tree->contains(5), false);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 3);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(4), 2);
+    ob->advance_clock(150);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_iceberg_displays_slice) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 10, order_type::ORDER_ICEBERG, -1, -1, -1, 3);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 3);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_reserve(), 7);
+};
+
+TEST(test_orderbook, test_iceberg_replenished_at_back) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 10, order_type::ORDER_ICEBERG, -1, -1, -1, 3);
+    ob->add_to_book(5, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 5);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_order_id(), 1);
+    ob->add_to_book(5, order_side::BID, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_order_id(), 0);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_reserve(), 4);
+};
+
+TEST(test_orderbook, test_iceberg_sweep_uses_reserve) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 10, order_type::ORDER_ICEBERG, -1, -1, -1, 3);
+    ob->add_to_book(5, order_side::BID, 9, order_type::ORDER_MARKET);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 1);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_reserve(), 0);
+    EXPECT_EQ(ob->cancel_order(0), true);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_iceberg_level_flag_cleared_when_drained) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::ASK, 4, order_type::ORDER_ICEBERG, -1, -1, -1, 2);
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->has_icebergs(5), true);
+    ob->add_to_book(5, order_side::BID, 7, order_type::ORDER_MARKET);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->ask_map->has_icebergs(5), false);
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 4, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_order_id(), 4);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 2);
+};
+
+TEST(test_orderbook, test_modify_reduce_keeps_priority) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 5, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 4, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->modify_order(0, 2, 5), true);
+    EXPECT_EQ(ob->bid_map->get_priority_order(5)->get_order_id(), 0);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 6);
+    EXPECT_EQ(ob->available_volume(order_side::ASK, 5), 6);
+};
+
+TEST(test_orderbook, test_modify_increase_loses_priority) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 5, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 4, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->modify_order(0, 8, 5), true);
+    EXPECT_EQ(ob->bid_map->get_priority_order(5)->get_order_id(), 1);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), 12);
+};
+
+TEST(test_orderbook, test_modify_price_moves_order) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 5, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->modify_order(0, 5, 3), true);
+    EXPECT_EQ(ob->bid_map->is_empty(5), true);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 3);
+    EXPECT_EQ(ob->cancel_order(0), true);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_modify_price_crosses) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(6, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::BID, 5, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->modify_order(1, 5, 6), true);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 3);
+    EXPECT_EQ(ob->bid_map->is_empty(4), true);
+    EXPECT_EQ(ob->last_trade_price, 6);
+};
+
+TEST(test_orderbook, test_modify_unknown_order) {
+    orderbook::book* ob = new orderbook::book{10};
+    EXPECT_EQ(ob->modify_order(3, 5, 5), false);
+    ob->add_to_book(5, order_side::BID, 5, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->modify_order(0, 5, 50), false);
+};
+
+struct fill_totals {
+    std::int64_t batches = 0;
+    std::int64_t fills = 0;
+    std::int64_t volume = 0;
+};
+
+void count_fills(const orderbook::events::fill_event* events, std::int64_t n_events, void* context) {
+    fill_totals* totals = static_cast<fill_totals*>(context);
+    totals->batches++;
+    totals->fills += n_events;
+    for (std::int64_t i = 0; i < n_events; i++) {
+        totals->volume += events[i].size;
+    }
+}
+
+TEST(test_orderbook, test_bulk_sweep_batches_fills) {
+    orderbook::book* ob = new orderbook::book{10};
+    fill_totals totals;
+    ob->set_fill_handler(count_fills, &totals);
+    for (std::int64_t i = 0; i < 500; i++) {
+        ob->add_to_book(5 + i % 2, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    }
+    ob->add_to_book(6, order_side::BID, 999, order_type::ORDER_MARKET);
+    EXPECT_EQ(totals.batches, 1);
+    EXPECT_EQ(totals.fills, 500);
+    EXPECT_EQ(totals.volume, 999);
+    EXPECT_EQ(ob->ask_map->is_empty(5), true);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(6), 1);
+    EXPECT_EQ(ob->get_stats().ask_resting_orders, 1);
+};
+
+TEST(test_orderbook, test_add_orders_defers_matching) {
+    orderbook::book* ob = new orderbook::book{10};
+    fill_totals totals;
+    ob->set_fill_handler(count_fills, &totals);
+    orderbook::command commands[] = {
+        orderbook::command::add(5, order_side::ASK, 3, order_type::ORDER_LIMIT),
+        orderbook::command::add(6, order_side::BID, 2, order_type::ORDER_LIMIT),
+        orderbook::command::add(6, order_side::BID, 4, order_type::ORDER_LIMIT),
+        orderbook::command::add(4, order_side::ASK, 1, order_type::ORDER_LIMIT),
+    };
+    ob->add_orders(commands, 4);
+    EXPECT_EQ(totals.batches, 1);
+    EXPECT_EQ(totals.volume, 4);
+    EXPECT_EQ(ob->can_match_orders(), false);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 2);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+};
+
+TEST(test_orderbook, test_add_orders_cancel_before_match) {
+    orderbook::book* ob = new orderbook::book{10};
+    orderbook::command commands[] = {
+        orderbook::command::add(5, order_side::ASK, 3, order_type::ORDER_LIMIT),
+        orderbook::command::add(6, order_side::BID, 2, order_type::ORDER_LIMIT),
+        orderbook::command::cancel(0),
+    };
+    ob->add_orders(commands, 3);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 2);
+    EXPECT_EQ(ob->last_trade_price, -1);
+};
+
+TEST(test_orderbook, test_add_orders_match_point) {
+    orderbook::book* ob = new orderbook::book{10};
+    orderbook::command commands[] = {
+        orderbook::command::add(5, order_side::ASK, 3, order_type::ORDER_LIMIT),
+        orderbook::command::add(6, order_side::BID, 2, order_type::ORDER_LIMIT),
+        orderbook::command::match(),
+        orderbook::command::cancel(0),
+        orderbook::command::add(7, order_side::BID, 1, order_type::ORDER_MARKET),
+        orderbook::command::add(50, order_side::BID, 1, order_type::ORDER_LIMIT),
+    };
+    ob->add_orders(commands, 6);
+    EXPECT_EQ(ob->last_trade_price, 5);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(7), 1);
+    EXPECT_EQ(ob->get_stats().dropped_orders, 1);
+};
+
+TEST(test_orderbook, test_auction_accumulates_crossed) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->set_auction_mode(true);
+    ob->add_to_book(4, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 2, order_type::ORDER_FILL_OR_KILL);
+    ob->match_orders();
+    EXPECT_EQ(ob->can_match_orders(), true);
+    EXPECT_EQ(ob->last_trade_price, -1);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 3);
+};
+
+TEST(test_orderbook, test_uncross_maximises_volume) {
+    orderbook::book* ob = new orderbook::book{10};
+    fill_totals totals;
+    ob->set_fill_handler(count_fills, &totals);
+    ob->set_auction_mode(true);
+    ob->add_to_book(7, order_side::BID, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::BID, 5, order_type::ORDER_LIMIT);
+    ob->add_to_book(3, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(7, order_side::ASK, 6, order_type::ORDER_LIMIT);
+    // At 5 and 6 demand 5 meets supply 5 with no imbalance; with no last trade, 5 is nearer the lowest ask.
+    EXPECT_EQ(ob->uncross(), 5);
+    EXPECT_EQ(totals.volume, 5);
+    EXPECT_EQ(ob->last_trade_price, 5);
+    EXPECT_EQ(ob->can_match_orders(), false);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 4);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 7);
+};
+
+TEST(test_orderbook, test_uncross_partial_level) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->set_auction_mode(true);
+    ob->add_to_book(6, order_side::BID, 10, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->uncross(), 6);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(6), 4);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->uncross(), -1);
+};
+
+TEST(test_orderbook, test_pro_rata_allocation) {
+    orderbook::basic_book<orderbook::matching::pro_rata>* ob = new orderbook::basic_book<orderbook::matching::pro_rata>{10};
+    ob->add_to_book(5, order_side::ASK, 10, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 30, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 60, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 50, order_type::ORDER_MARKET);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 50);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_size(), 5);
+    EXPECT_EQ(ob->ask_map->get_queue(5)->at(1)->get_size(), 15);
+    EXPECT_EQ(ob->ask_map->get_queue(5)->at(2)->get_size(), 30);
+};
+
+TEST(test_orderbook, test_pro_rata_rounding_is_deterministic) {
+    orderbook::basic_book<orderbook::matching::pro_rata>* ob = new orderbook::basic_book<orderbook::matching::pro_rata>{10};
+    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 2, order_type::ORDER_MARKET);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 1);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_order_id(), 2);
+    EXPECT_EQ(ob->get_stats().ask_resting_orders, 1);
+    EXPECT_EQ(ob->available_volume(order_side::BID, 5), 1);
+};
+
+TEST(test_orderbook, test_top_order_pro_rata) {
+    orderbook::basic_book<orderbook::matching::top_order_pro_rata>* ob = new orderbook::basic_book<orderbook::matching::top_order_pro_rata>{10};
+    ob->add_to_book(5, order_side::ASK, 10, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 20, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::ASK, 20, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 20, order_type::ORDER_MARKET);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_order_id(), 1);
+    EXPECT_EQ(ob->ask_map->get_priority_order(5)->get_size(), 15);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(5), 30);
+};
+
+TEST(test_orderbook, test_sweep_through_cold_levels) {
+    orderbook::book* ob = new orderbook::book{40};
+    for (std::int64_t tick_level = 10; tick_level < 30; tick_level++) {
+        ob->add_to_book(tick_level, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    EXPECT_EQ(ob->ask_tree->get_n_hot_levels(), 8);
+    ob->add_to_book(24, order_side::BID, 17, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 25);
+    EXPECT_EQ(ob->ask_tree->get_max_value(), 29);
+    EXPECT_EQ(ob->ask_tree->get_n_live_levels(), 5);
+    EXPECT_EQ(ob->bid_tree->is_empty(), false);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 24);
+};
+
+TEST(test_orderbook, test_load_snapshot) {
+    orderbook::book* ob = new orderbook::book{100};
+    orderbook::command commands[40];
+    std::int64_t n = 0;
+    for (std::int64_t tick_level = 30; tick_level < 50; tick_level++) {
+        commands[n++] = orderbook::command::add(tick_level, order_side::BID, 2, order_type::ORDER_LIMIT);
+    }
+    for (std::int64_t tick_level = 50; tick_level < 60; tick_level++) {
+        commands[n++] = orderbook::command::add(tick_level, order_side::ASK, 1, order_type::ORDER_LIMIT);
+        commands[n++] = orderbook::command::add(tick_level, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    }
+    EXPECT_EQ(ob->load_snapshot(commands, n), true);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 49);
+    EXPECT_EQ(ob->bid_tree->get_min_value(), 30);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 50);
+    EXPECT_EQ(ob->ask_tree->get_n_live_levels(), 10);
+    EXPECT_EQ(ob->ask_map->get_total_volume_at_tick_level(55), 4);
+    EXPECT_EQ(ob->available_volume(order_side::ASK, 40), 20);
+    EXPECT_EQ(ob->cancel_order(20), true);
+    ob->add_to_book(50, order_side::BID, 4, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 51);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 50);
+    EXPECT_EQ(ob->get_stats().bid_resting_orders, 21);
+};
+
+TEST(test_orderbook, test_load_snapshot_rejected) {
+    orderbook::book* ob = new orderbook::book{100};
+    orderbook::command unsorted[2] = {
+        orderbook::command::add(40, order_side::BID, 1, order_type::ORDER_LIMIT),
+        orderbook::command::add(39, order_side::BID, 1, order_type::ORDER_LIMIT),
+    };
+    orderbook::command crossed[2] = {
+        orderbook::command::add(40, order_side::BID, 1, order_type::ORDER_LIMIT),
+        orderbook::command::add(40, order_side::ASK, 1, order_type::ORDER_LIMIT),
+    };
+    EXPECT_EQ(ob->load_snapshot(unsorted, 2), false);
+    EXPECT_EQ(ob->load_snapshot(crossed, 2), false);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    ob->add_to_book(10, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    orderbook::command bids[1] = {orderbook::command::add(5, order_side::BID, 1, order_type::ORDER_LIMIT)};
+    EXPECT_EQ(ob->load_snapshot(bids, 1), false);
+};
+
+TEST(test_orderbook, test_queue_position) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->queue_position(2).orders_ahead, 2);
+    EXPECT_EQ(ob->queue_position(2).volume_ahead, 5);
+    EXPECT_EQ(ob->queue_position(3).orders_ahead, 0);
+    ob->add_to_book(5, order_side::ASK, 3, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->queue_position(1).orders_ahead, 0);
+    EXPECT_EQ(ob->queue_position(2).orders_ahead, 1);
+    EXPECT_EQ(ob->queue_position(2).volume_ahead, 2);
+    EXPECT_EQ(ob->cancel_order(1), true);
+    EXPECT_EQ(ob->queue_position(2).volume_ahead, 0);
+    EXPECT_EQ(ob->queue_position(0).orders_ahead, -1);
+    EXPECT_EQ(ob->queue_position(1).volume_ahead, -1);
+    EXPECT_EQ(ob->queue_position(42).orders_ahead, -1);
+};
+
+TEST(test_orderbook, test_cancel_all_and_range) {
+    orderbook::book* ob = new orderbook::book{100};
+    for (std::int64_t tick_level = 10; tick_level < 30; tick_level++) {
+        ob->add_to_book(tick_level, order_side::BID, 2, order_type::ORDER_LIMIT);
+        ob->add_to_book(tick_level, order_side::BID, 1, order_type::ORDER_LIMIT);
+        ob->add_to_book(tick_level + 40, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    }
+    EXPECT_EQ(ob->cancel_range(order_side::BID, 15, 24), 20);
+    EXPECT_EQ(ob->bid_tree->get_n_live_levels(), 10);
+    EXPECT_EQ(ob->bid_tree->contains(15), false);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 29);
+    EXPECT_EQ(ob->available_volume(order_side::ASK, 0), 30);
+    EXPECT_EQ(ob->cancel_order(15 * 3 - 30), false);
+    EXPECT_EQ(ob->cancel_all(order_side::BID), 20);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    EXPECT_EQ(ob->get_stats().bid_resting_orders, 0);
+    EXPECT_EQ(ob->get_stats().ask_resting_orders, 20);
+    ob->add_to_book(50, order_side::BID, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 51);
+};
+
+TEST(test_orderbook, test_cancel_owner) {
+    orderbook::book* ob = new orderbook::book{100};
+    ob->add_to_book(10, order_side::BID, 1, order_type::ORDER_LIMIT, -1, -1, -1, -1, 7);
+    ob->add_to_book(10, order_side::BID, 2, order_type::ORDER_LIMIT, -1, -1, -1, -1, 8);
+    ob->add_to_book(11, order_side::BID, 3, order_type::ORDER_LIMIT, -1, -1, -1, -1, 7);
+    ob->add_to_book(20, order_side::ASK, 10, order_type::ORDER_ICEBERG, -1, -1, -1, 4, 7);
+    orderbook::command commands[1] = {orderbook::command::add(21, order_side::ASK, 5, order_type::ORDER_LIMIT, -1, -1, -1, 7)};
+    ob->add_orders(commands, 1);
+    std::int64_t n_events = 0;
+    ob->set_mass_cancel_handler([](const orderbook::events::mass_cancel_event*, std::int64_t n, void* context) {
+        *static_cast<std::int64_t*>(context) += n;
+    }, &n_events);
+    EXPECT_EQ(ob->cancel_owner(7), 4);
+    EXPECT_EQ(n_events, 2);
+    EXPECT_EQ(ob->bid_tree->get_max_value(), 10);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(10), 2);
+    EXPECT_EQ(ob->ask_tree->is_empty(), true);
+    EXPECT_EQ(ob->queue_position(1).orders_ahead, 0);
+    EXPECT_EQ(ob->cancel_owner(7), 0);
+};
+
+TEST(test_orderbook, test_cancel_owner_deep_level) {
+    // Owner cancels tombstone a level front to back, each appended to the level's reduced list in O(1).
+    std::int64_t n_orders = 20000;
+    orderbook::book* ob = new orderbook::book{10};
+    orderbook::command* commands = new orderbook::command[n_orders];
+    for (std::int64_t i = 0; i < n_orders; i++) {
+        commands[i] = orderbook::command::add(5, order_side::BID, 1, order_type::ORDER_LIMIT, -1, -1, -1, i % 2);
+    }
+    EXPECT_EQ(ob->load_snapshot(commands, n_orders), true);
+    EXPECT_EQ(ob->cancel_owner(1), n_orders / 2);
+    EXPECT_EQ(ob->bid_map->get_total_volume_at_tick_level(5), n_orders / 2);
+    EXPECT_EQ(ob->queue_position(n_orders - 2).orders_ahead, n_orders / 2 - 1);
+    EXPECT_EQ(ob->queue_position(n_orders - 2).volume_ahead, n_orders / 2 - 1);
+    EXPECT_EQ(ob->queue_position(n_orders - 1).orders_ahead, -1);
+    EXPECT_EQ(ob->cancel_owner(0), n_orders / 2);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+    delete[] commands;
+};
+
+TEST(test_orderbook, test_cancel_all_cancels_stops) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(6, order_side::BID, 5, order_type::ORDER_STOP_LIMIT, 7);
+    ob->add_to_book(3, order_side::BID, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(8, order_side::BID, 5, order_type::ORDER_STOP_LIMIT, 8, -1, -1, -1, 4);
+    EXPECT_EQ(ob->cancel_owner(4), 1);
+    EXPECT_EQ(ob->get_stats().bid_stop_orders, 1);
+    EXPECT_EQ(ob->cancel_all(order_side::BID), 2);
+    EXPECT_EQ(ob->get_stats().bid_stop_orders, 0);
+    ob->add_to_book(6, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::BID, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->last_trade_price, 6);
+    EXPECT_EQ(ob->bid_tree->is_empty(), true);
+};
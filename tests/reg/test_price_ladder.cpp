@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <set>
+#include <orderbook/trees/price_ladder.h>
+
+TEST(price_ladder_test, test_is_empty) {
+    orderbook::trees::price_ladder* ladder = new orderbook::trees::price_ladder{100, order_side::BID};
+    EXPECT_EQ(ladder->is_empty(), true);
+    ladder->insert(5);
+    EXPECT_EQ(ladder->is_empty(), false);
+    ladder->remove(5);
+    EXPECT_EQ(ladder->is_empty(), true);
+};
+
+TEST(price_ladder_test, test_bid_best_and_worst) {
+    orderbook::trees::price_ladder* ladder = new orderbook::trees::price_ladder{100, order_side::BID};
+    for (std::int64_t tick_level = 10; tick_level < 30; tick_level++) {
+        ladder->insert(tick_level);
+    }
+    EXPECT_EQ(ladder->get_best_value(), 29);
+    EXPECT_EQ(ladder->get_max_value(), 29);
+    EXPECT_EQ(ladder->get_min_value(), 10);
+    EXPECT_EQ(ladder->get_n_hot_levels(), 8);
+    EXPECT_EQ(ladder->get_n_live_levels(), 20);
+    EXPECT_EQ(ladder->get_cold_tree()->get_max_value(), 21);
+};
+
+TEST(price_ladder_test, test_ask_promotes_on_remove) {
+    orderbook::trees::price_ladder* ladder = new orderbook::trees::price_ladder{100, order_side::ASK};
+    for (std::int64_t tick_level = 50; tick_level > 40; tick_level--) {
+        ladder->insert(tick_level);
+    }
+    EXPECT_EQ(ladder->get_best_value(), 41);
+    EXPECT_EQ(ladder->get_max_value(), 50);
+    for (std::int64_t tick_level = 41; tick_level < 49; tick_level++) {
+        ladder->remove(tick_level);
+    }
+    EXPECT_EQ(ladder->get_best_value(), 49);
+    EXPECT_EQ(ladder->get_n_hot_levels(), 2);
+    EXPECT_EQ(ladder->get_cold_tree()->is_empty(), true);
+};
+
+TEST(price_ladder_test, test_demotes_on_better_insert) {
+    orderbook::trees::price_ladder* ladder = new orderbook::trees::price_ladder{100, order_side::BID};
+    for (std::int64_t tick_level = 0; tick_level < 8; tick_level++) {
+        ladder->insert(tick_level);
+    }
+    ladder->insert(50);
+    EXPECT_EQ(ladder->get_best_value(), 50);
+    EXPECT_EQ(ladder->get_cold_tree()->contains(0), true);
+    EXPECT_EQ(ladder->contains(0), true);
+    EXPECT_EQ(ladder->contains(9), false);
+    ladder->insert(50);
+    EXPECT_EQ(ladder->get_n_live_levels(), 9);
+};
+
+TEST(price_ladder_test, test_matches_ordered_set) {
+    std::srand(7);
+    for (std::int64_t side : {std::int64_t(order_side::BID), std::int64_t(order_side::ASK)}) {
+        orderbook::trees::price_ladder* ladder = new orderbook::trees::price_ladder{64, side};
+        std::set<std::int64_t> levels;
+        for (std::int64_t i = 0; i < 5000; i++) {
+            std::int64_t tick_level = std::rand() % 64;
+            if (std::rand() % 2) {
+                ladder->insert(tick_level);
+                levels.insert(tick_level);
+            } else {
+                ladder->remove(tick_level);
+                levels.erase(tick_level);
+            }
+            ASSERT_EQ(ladder->is_empty(), levels.empty());
+            ASSERT_EQ(ladder->get_n_live_levels(), static_cast<std::int64_t>(levels.size()));
+            if (!levels.empty()) {
+                ASSERT_EQ(ladder->get_max_value(), *levels.rbegin());
+                ASSERT_EQ(ladder->get_min_value(), *levels.begin());
+            }
+        }
+        delete ladder;
+    }
+};
+
+TEST(price_ladder_test, test_bulk_load) {
+    std::int64_t tick_levels[20];
+    for (std::int64_t i = 0; i < 20; i++) {
+        tick_levels[i] = 10 + i;
+    }
+    orderbook::trees::price_ladder* bids = new orderbook::trees::price_ladder{100, order_side::BID};
+    orderbook::trees::price_ladder* asks = new orderbook::trees::price_ladder{100, order_side::ASK};
+    EXPECT_EQ(bids->bulk_load(tick_levels, 20), true);
+    EXPECT_EQ(asks->bulk_load(tick_levels, 20), true);
+    EXPECT_EQ(bids->get_best_value(), 29);
+    EXPECT_EQ(bids->get_min_value(), 10);
+    EXPECT_EQ(bids->get_cold_tree()->get_max_value(), 21);
+    EXPECT_EQ(asks->get_best_value(), 10);
+    EXPECT_EQ(asks->get_max_value(), 29);
+    EXPECT_EQ(asks->get_cold_tree()->get_min_value(), 18);
+    EXPECT_EQ(asks->get_n_live_levels(), 20);
+    asks->remove(10);
+    EXPECT_EQ(asks->get_best_value(), 11);
+    EXPECT_EQ(asks->contains(18), true);
+};
+
+TEST(price_ladder_test, test_find_next_level) {
+    orderbook::trees::price_ladder* bids = new orderbook::trees::price_ladder{100, order_side::BID};
+    for (std::int64_t tick_level = 10; tick_level < 40; tick_level += 3) {
+        bids->insert(tick_level);
+    }
+    std::int64_t n_levels = 0;
+    for (std::int64_t tick_level = bids->find_next_level(0); tick_level != -1; tick_level = bids->find_next_level(tick_level + 1)) {
+        EXPECT_EQ(tick_level, 10 + 3 * n_levels);
+        n_levels++;
+    }
+    EXPECT_EQ(n_levels, 10);
+    EXPECT_EQ(bids->find_next_level(35), 37);
+    EXPECT_EQ(bids->find_next_level(38), -1);
+};
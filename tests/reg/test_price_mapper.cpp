@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <orderbook/prices/price_mapper.h>
+#include <orderbook/orderbook/orderbook.h>
+
+TEST(price_mapper_test, test_fixed_tick) {
+    // LOBSTER prices are dollars x10000, a one cent tick is 100.
+    constexpr orderbook::prices::fixed_tick_mapper mapper{5850000, 100, 1000};
+    static_assert(mapper.to_tick(5850000) == 0);
+    static_assert(mapper.to_tick(5851200) == 12);
+    static_assert(mapper.to_price(12) == 5851200);
+    EXPECT_EQ(mapper.to_tick(5851250), -1);
+    EXPECT_EQ(mapper.to_tick(5849900), -1);
+    EXPECT_EQ(mapper.to_tick(5850000 + 1000 * 100), -1);
+    EXPECT_EQ(mapper.to_tick(5850000 + 999 * 100), 999);
+};
+
+TEST(price_mapper_test, test_tick_table) {
+    constexpr orderbook::prices::tick_band bands[3] = {{0, 1}, {1000, 5}, {5000, 10}};
+    constexpr orderbook::prices::tick_table_mapper<3> mapper{bands, 10000};
+    static_assert(mapper.get_n_tick_levels() == 1000 + 800 + 500);
+    static_assert(mapper.to_tick(999) == 999);
+    static_assert(mapper.to_tick(1000) == 1000);
+    static_assert(mapper.to_tick(1005) == 1001);
+    static_assert(mapper.to_tick(5000) == 1800);
+    EXPECT_EQ(mapper.to_tick(1003), -1);
+    EXPECT_EQ(mapper.to_tick(10000), -1);
+    EXPECT_EQ(mapper.to_tick(-1), -1);
+    for (std::int64_t tick_level = 0; tick_level < mapper.get_n_tick_levels(); tick_level++) {
+        EXPECT_EQ(mapper.to_tick(mapper.to_price(tick_level)), tick_level);
+    }
+};
+
+TEST(price_mapper_test, test_in_front_of_book) {
+    constexpr orderbook::prices::fixed_tick_mapper mapper{1000, 5, 100};
+    orderbook::book* ob = new orderbook::book{mapper.get_n_tick_levels()};
+    ob->add_to_book(mapper.to_tick(1250), order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(mapper.to_tick(1245), order_side::BID, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(mapper.to_price(ob->ask_tree->get_min_value()), 1250);
+    EXPECT_EQ(mapper.to_price(ob->bid_tree->get_max_value()), 1245);
+};
+
+TEST(price_mapper_test, test_off_grid_dropped) {
+    constexpr orderbook::prices::fixed_tick_mapper mapper{1000, 5, 100};
+    orderbook::book* ob = new orderbook::book{mapper.get_n_tick_levels()};
+    ob->add_to_book(mapper.to_tick(1252), order_side::ASK, 3, order_type::ORDER_LIMIT);
+    ob->add_to_book(mapper.to_tick(995), order_side::BID, 2, order_type::ORDER_LIMIT);
+    orderbook::command commands[1] = {orderbook::command::add(mapper.to_tick(1253), order_side::ASK, 1, order_type::ORDER_LIMIT)};
+    ob->add_orders(commands, 1);
+    EXPECT_EQ(ob->get_stats().dropped_orders, 3);
+    EXPECT_EQ(ob->ask_tree->find_next_level(0), -1);
+    EXPECT_EQ(ob->bid_tree->find_next_level(0), -1);
+};
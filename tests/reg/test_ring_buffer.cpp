@@ -84,4 +84,171 @@ TEST(ring_buffer_test, test_reduce_tail) {
     ring_buffer->reduce_size_of_tail(2);
     orderbook::order* order = ring_buffer->dequeue();
     EXPECT_EQ(order->get_size(), 97);
-};
\ No newline at end of file
+};
+TEST(ring_buffer_test, test_grow_when_full) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    for (std::int64_t i = 0; i < 6; i++) {
+        ring_buffer->enqueue(i, 1, 10, 1, 88);
+    }
+    EXPECT_EQ(ring_buffer->get_capacity(), 8);
+    EXPECT_EQ(ring_buffer->get_total_volume(), 60);
+    EXPECT_EQ(ring_buffer->dequeue()->get_order_id(), 0);
+};
+
+TEST(ring_buffer_test, test_grow_after_wrap_around) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    ring_buffer->enqueue(0, 1, 10, 1, 88);
+    ring_buffer->enqueue(1, 1, 10, 1, 88);
+    ring_buffer->enqueue(2, 1, 10, 1, 88);
+    ring_buffer->dequeue();
+    ring_buffer->dequeue();
+    for (std::int64_t i = 3; i < 9; i++) {
+        ring_buffer->enqueue(i, 1, 10, 1, 88);
+    }
+    EXPECT_EQ(ring_buffer->get_size(), 7);
+    EXPECT_EQ(ring_buffer->get_total_volume(), 70);
+    for (std::int64_t i = 2; i < 9; i++) {
+        EXPECT_EQ(ring_buffer->dequeue()->get_order_id(), i);
+    }
+};
+
+TEST(ring_buffer_test, test_grow_from_grower) {
+    orderbook::pools::pool_grower* grower = new orderbook::pools::pool_grower{};
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4, grower};
+    for (std::int64_t i = 0; i < 1000; i++) {
+        ring_buffer->enqueue(i, 1, 1, 1, 88);
+    }
+    EXPECT_EQ(ring_buffer->get_total_volume(), 1000);
+    EXPECT_EQ(ring_buffer->peek()->get_order_id(), 0);
+    delete grower;
+    delete ring_buffer;
+};
+
+TEST(ring_buffer_test, test_cancel_middle) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    ring_buffer->enqueue(0, 1, 10, 1, 88);
+    std::int64_t sequence = ring_buffer->enqueue(1, 1, 20, 1, 88);
+    ring_buffer->enqueue(2, 1, 30, 1, 88);
+    ring_buffer->cancel(sequence);
+    EXPECT_EQ(ring_buffer->get_total_volume(), 40);
+    EXPECT_EQ(ring_buffer->find(sequence, 1), nullptr);
+    EXPECT_EQ(ring_buffer->dequeue()->get_order_id(), 0);
+    EXPECT_EQ(ring_buffer->peek()->get_order_id(), 2);
+};
+
+TEST(ring_buffer_test, test_cancel_all_is_empty) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    std::int64_t first = ring_buffer->enqueue(0, 1, 10, 1, 88);
+    std::int64_t second = ring_buffer->enqueue(1, 1, 10, 1, 88);
+    ring_buffer->cancel(second);
+    ring_buffer->cancel(first);
+    EXPECT_EQ(ring_buffer->is_empty(), true);
+    EXPECT_EQ(ring_buffer->get_total_volume(), 0);
+};
+
+TEST(ring_buffer_test, test_sequence_survives_growth) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    ring_buffer->enqueue(0, 1, 10, 1, 88);
+    ring_buffer->dequeue();
+    std::int64_t sequence = ring_buffer->enqueue(1, 1, 10, 1, 88);
+    for (std::int64_t i = 2; i < 10; i++) {
+        ring_buffer->enqueue(i, 1, 10, 1, 88);
+    }
+    ASSERT_NE(ring_buffer->find(sequence, 1), nullptr);
+    EXPECT_EQ(ring_buffer->find(sequence, 1)->get_order_id(), 1);
+};
+
+TEST(ring_buffer_test, test_fill_from_tail) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    ring_buffer->enqueue(0, 1, 2, 1, 88);
+    std::int64_t sequence = ring_buffer->enqueue(1, 1, 3, 1, 88);
+    ring_buffer->enqueue(2, 1, 4, 1, 88);
+    ring_buffer->enqueue(3, 1, 5, 1, 88);
+    ring_buffer->cancel(sequence);
+    std::int64_t n_filled = 0;
+    orderbook::queues::batch_fill filled = ring_buffer->fill_from_tail(8, [&](orderbook::order*) { n_filled++; });
+    EXPECT_EQ(filled.orders, 2);
+    EXPECT_EQ(filled.volume, 6);
+    EXPECT_EQ(n_filled, 2);
+    EXPECT_EQ(ring_buffer->peek()->get_order_id(), 3);
+    EXPECT_EQ(ring_buffer->get_total_volume(), 5);
+};
+
+TEST(ring_buffer_test, test_enqueue_bulk_grows_once) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{10};
+    ring_buffer->enqueue(0, 1, 1, 1, -1);
+    std::int64_t first = ring_buffer->enqueue_bulk(25, [](std::int64_t k, orderbook::order* order) {
+        order->set_order_attributes(k + 1, 2, 1, 1, -1);
+    });
+    EXPECT_EQ(first, 1);
+    EXPECT_EQ(ring_buffer->get_capacity(), 30);
+    EXPECT_EQ(ring_buffer->get_growths(), 1);
+    EXPECT_EQ(ring_buffer->get_size(), 26);
+    EXPECT_EQ(ring_buffer->get_total_volume(), 51);
+    EXPECT_EQ(ring_buffer->find(first + 24, 25)->get_size(), 2);
+};
+
+TEST(ring_buffer_test, test_queue_position) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    std::int64_t first = ring_buffer->enqueue(0, 1, 2, 1, 88);
+    std::int64_t second = ring_buffer->enqueue(1, 1, 3, 1, 88);
+    std::int64_t third = ring_buffer->enqueue(2, 1, 4, 1, 88);
+    std::int64_t last = ring_buffer->enqueue(3, 1, 5, 1, 88);
+    EXPECT_EQ(ring_buffer->get_queue_position(first).orders_ahead, 0);
+    EXPECT_EQ(ring_buffer->get_queue_position(first).volume_ahead, 0);
+    EXPECT_EQ(ring_buffer->get_queue_position(last).orders_ahead, 3);
+    EXPECT_EQ(ring_buffer->get_queue_position(last).volume_ahead, 9);
+    ring_buffer->reduce_size_of_tail(1);
+    ring_buffer->reduce_size(third, 3);
+    ring_buffer->cancel(second);
+    EXPECT_EQ(ring_buffer->get_queue_position(third).orders_ahead, 1);
+    EXPECT_EQ(ring_buffer->get_queue_position(third).volume_ahead, 1);
+    EXPECT_EQ(ring_buffer->get_queue_position(last).orders_ahead, 2);
+    EXPECT_EQ(ring_buffer->get_queue_position(last).volume_ahead, 2);
+    ring_buffer->dequeue();
+    EXPECT_EQ(ring_buffer->get_queue_position(third).orders_ahead, 0);
+    EXPECT_EQ(ring_buffer->get_queue_position(last).orders_ahead, 1);
+    EXPECT_EQ(ring_buffer->get_queue_position(last).volume_ahead, 1);
+};
+
+TEST(ring_buffer_test, test_queue_position_across_growth) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{4};
+    std::int64_t sequences[12];
+    for (std::int64_t i = 0; i < 12; i++) {
+        sequences[i] = ring_buffer->enqueue(i, 1, i + 1, 1, 88);
+    }
+    ring_buffer->cancel(sequences[3]);
+    ring_buffer->cancel(sequences[7]);
+    ring_buffer->reduce_size(sequences[5], 2);
+    ring_buffer->dequeue();
+    ring_buffer->dequeue();
+    // Ahead of order 11: orders 2..10 less the cancelled 3 and 7, volume 3+5+4+7+9+10+11.
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[11]).orders_ahead, 7);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[11]).volume_ahead, 49);
+    for (std::int64_t i = 0; i < 5; i++) {
+        ring_buffer->dequeue();
+    }
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[11]).orders_ahead, 2);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[11]).volume_ahead, 21);
+};
+
+TEST(ring_buffer_test, test_queue_position_out_of_order_reductions) {
+    orderbook::queues::ring_buffer* ring_buffer = new orderbook::queues::ring_buffer{10};
+    std::int64_t sequences[8];
+    for (std::int64_t i = 0; i < 8; i++) {
+        sequences[i] = ring_buffer->enqueue(i, 1, 2, 1, 88);
+    }
+    ring_buffer->cancel(sequences[5]);
+    ring_buffer->cancel(sequences[2]);
+    ring_buffer->reduce_size(sequences[6], 1);
+    ring_buffer->cancel(sequences[3]);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[7]).orders_ahead, 4);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[7]).volume_ahead, 7);
+    ring_buffer->dequeue();
+    ring_buffer->dequeue();
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[7]).orders_ahead, 2);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[7]).volume_ahead, 3);
+    ring_buffer->cancel(sequences[4]);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[7]).orders_ahead, 1);
+    EXPECT_EQ(ring_buffer->get_queue_position(sequences[7]).volume_ahead, 1);
+};
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook/orderbook.h>
+
+using orderbook::matching::ask_side;
+using orderbook::matching::bid_side;
+using orderbook::matching::side_traits;
+
+TEST(side_traits_test, test_price_comparisons) {
+    EXPECT_TRUE(side_traits<bid_side>::is_better(6, 5));
+    EXPECT_FALSE(side_traits<bid_side>::is_better(5, 6));
+    EXPECT_TRUE(side_traits<ask_side>::is_better(5, 6));
+    EXPECT_TRUE(side_traits<bid_side>::can_trade_at(5, 5));
+    EXPECT_FALSE(side_traits<bid_side>::can_trade_at(4, 5));
+    EXPECT_TRUE(side_traits<ask_side>::can_trade_at(5, 5));
+    EXPECT_FALSE(side_traits<ask_side>::can_trade_at(6, 5));
+    EXPECT_EQ(side_traits<bid_side>::side, order_side::BID);
+    EXPECT_EQ(side_traits<side_traits<bid_side>::opposite>::side, order_side::ASK);
+};
+
+TEST(side_traits_test, test_selects_book_side) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(3, order_side::BID, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(5, order_side::BID, 1, order_type::ORDER_LIMIT);
+    ob->add_to_book(7, order_side::ASK, 4, order_type::ORDER_LIMIT);
+    ob->add_to_book(8, order_side::ASK, 1, order_type::ORDER_LIMIT);
+    EXPECT_EQ(side_traits<bid_side>::tree(ob), ob->bid_tree);
+    EXPECT_EQ(side_traits<ask_side>::map(ob), ob->ask_map);
+    EXPECT_EQ(side_traits<bid_side>::best(side_traits<bid_side>::tree(ob)), 5);
+    EXPECT_EQ(side_traits<ask_side>::best(side_traits<ask_side>::tree(ob)), 7);
+    EXPECT_EQ(side_traits<bid_side>::volume_within(ob->ask_map, 7), 4);
+    EXPECT_EQ(side_traits<ask_side>::volume_within(ob->bid_map, 3), 3);
+    delete ob;
+};
+
+TEST(side_traits_test, test_sweep_each_side) {
+    orderbook::book* ob = new orderbook::book{10};
+    ob->add_to_book(5, order_side::BID, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(4, order_side::BID, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(6, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    ob->add_to_book(7, order_side::ASK, 2, order_type::ORDER_LIMIT);
+    EXPECT_EQ(ob->sweep<bid_side>(10, 6, 3), 1);
+    EXPECT_EQ(ob->ask_tree->get_min_value(), 7);
+    EXPECT_EQ(ob->sweep<ask_side>(11, 4, 5), 1);
+    EXPECT_TRUE(ob->bid_tree->is_empty());
+    EXPECT_EQ(ob->last_trade_price, 4);
+    delete ob;
+};
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <orderbook/maps/stop_map.h>
+
+TEST(stop_map_test, test_buy_stop_triggered) {
+    orderbook::maps::stop_map* stops = new orderbook::maps::stop_map{10, order_side::BID};
+    stops->add_order(1, 6, 5, 7);
+    stops->add_order(2, 4, 5, 7);
+    EXPECT_EQ(stops->get_triggered_level(3), -1);
+    EXPECT_EQ(stops->get_triggered_level(5), 4);
+};
+
+TEST(stop_map_test, test_sell_stop_triggered) {
+    orderbook::maps::stop_map* stops = new orderbook::maps::stop_map{10, order_side::ASK};
+    stops->add_order(1, 6, 5, 5);
+    stops->add_order(2, 4, 5, 3);
+    EXPECT_EQ(stops->get_triggered_level(7), -1);
+    EXPECT_EQ(stops->get_triggered_level(5), 6);
+    EXPECT_EQ(stops->get_triggered_level(-1), -1);
+};
+
+TEST(stop_map_test, test_remove_priority_order) {
+    orderbook::maps::stop_map* stops = new orderbook::maps::stop_map{10, order_side::BID};
+    stops->add_order(1, 4, 5, 7);
+    stops->add_order(2, 4, 6, 7);
+    stops->add_order(3, 8, 5, 9);
+    EXPECT_EQ(stops->remove_priority_order(4)->get_order_id(), 1);
+    EXPECT_EQ(stops->get_nearest_trigger(), 4);
+    stops->remove_priority_order(4);
+    EXPECT_EQ(stops->get_nearest_trigger(), 8);
+    stops->remove_priority_order(8);
+    EXPECT_EQ(stops->get_nearest_trigger(), -1);
+};
+
+TEST(stop_map_test, test_limit_price_kept) {
+    orderbook::maps::stop_map* stops = new orderbook::maps::stop_map{10, order_side::BID};
+    stops->add_order(1, 4, 5, 7);
+    orderbook::order* order = stops->remove_priority_order(4);
+    EXPECT_EQ(order->get_limit_price(), 7);
+    EXPECT_EQ(order->get_type(), order_type::ORDER_STOP_LIMIT);
+};
+
+TEST(stop_map_test, test_cancel_range_moves_nearest_trigger) {
+    orderbook::maps::stop_map* stops = new orderbook::maps::stop_map{20, order_side::BID};
+    stops->add_order(1, 4, 5, -1);
+    stops->add_order(2, 4, 5, -1);
+    stops->add_order(3, 9, 5, -1);
+    stops->add_order(4, 15, 5, -1);
+    EXPECT_EQ(stops->cancel_range(0, 10), 3);
+    EXPECT_EQ(stops->get_nearest_trigger(), 15);
+    EXPECT_EQ(stops->get_triggered_level(9), -1);
+    EXPECT_EQ(stops->cancel_orders_if(0, 19, [](orderbook::order* order) { return order->get_order_id() == 4; }), 1);
+    EXPECT_EQ(stops->get_nearest_trigger(), -1);
+    EXPECT_EQ(stops->get_resting_orders(), 0);
+};
@@ -32,4 +32,32 @@ TEST(tick_level_bitmap_test, test_set_is_set_five) {
     bitmap->set(1);
     bitmap->set(1);
     EXPECT_EQ(bitmap->is_set(1),true);
-};
\ No newline at end of file
+};
+TEST(tick_level_bitmap_test, test_find_next_set_one) {
+    orderbook::bitmaps::tick_level_bitmap* bitmap = new orderbook::bitmaps::tick_level_bitmap{};
+    bitmap->set(3);
+    bitmap->set(700);
+    EXPECT_EQ(bitmap->find_next_set(0),3);
+    EXPECT_EQ(bitmap->find_next_set(3),3);
+    EXPECT_EQ(bitmap->find_next_set(4),700);
+    EXPECT_EQ(bitmap->find_next_set(701),-1);
+};
+
+TEST(tick_level_bitmap_test, test_find_prev_set_one) {
+    orderbook::bitmaps::tick_level_bitmap* bitmap = new orderbook::bitmaps::tick_level_bitmap{};
+    bitmap->set(3);
+    bitmap->set(700);
+    EXPECT_EQ(bitmap->find_prev_set(999999),700);
+    EXPECT_EQ(bitmap->find_prev_set(700),700);
+    EXPECT_EQ(bitmap->find_prev_set(699),3);
+    EXPECT_EQ(bitmap->find_prev_set(2),-1);
+};
+
+TEST(tick_level_bitmap_test, test_sized_bitmap_bounds) {
+    orderbook::bitmaps::tick_level_bitmap* bitmap = new orderbook::bitmaps::tick_level_bitmap{100};
+    bitmap->set(99);
+    EXPECT_EQ(bitmap->find_next_set(0), 99);
+    EXPECT_EQ(bitmap->find_next_set(100), -1);
+    EXPECT_EQ(bitmap->find_prev_set(5000), 99);
+    delete bitmap;
+};
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <vector>
+#include <orderbook/timers/timing_wheel.h>
+
+TEST(timing_wheel_test, test_expires_at_time) {
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{16};
+    std::vector<std::int64_t> expired;
+    wheel->schedule(1, 5);
+    wheel->advance(4, [&](std::int64_t id) { expired.push_back(id); });
+    EXPECT_EQ(expired.size(), 0);
+    wheel->advance(5, [&](std::int64_t id) { expired.push_back(id); });
+    ASSERT_EQ(expired.size(), 1);
+    EXPECT_EQ(expired[0], 1);
+    EXPECT_EQ(wheel->get_pending(), 0);
+};
+
+TEST(timing_wheel_test, test_expires_in_order_across_levels) {
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{16};
+    std::vector<std::int64_t> expired;
+    wheel->schedule(3, 300000);
+    wheel->schedule(2, 5000);
+    wheel->schedule(1, 70);
+    wheel->advance(69, [&](std::int64_t id) { expired.push_back(id); });
+    EXPECT_EQ(expired.size(), 0);
+    wheel->advance(5000, [&](std::int64_t id) { expired.push_back(id); });
+    ASSERT_EQ(expired.size(), 2);
+    EXPECT_EQ(expired[0], 1);
+    EXPECT_EQ(expired[1], 2);
+    wheel->advance(299999, [&](std::int64_t id) { expired.push_back(id); });
+    EXPECT_EQ(expired.size(), 2);
+    wheel->advance(300000, [&](std::int64_t id) { expired.push_back(id); });
+    EXPECT_EQ(expired.size(), 3);
+    EXPECT_EQ(wheel->get_time(), 300000);
+};
+
+TEST(timing_wheel_test, test_expiry_beyond_top_level) {
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{16};
+    std::int64_t expired_at = -1;
+    wheel->schedule(1, 40000000);
+    wheel->advance(50000000, [&](std::int64_t) { expired_at = wheel->get_time(); });
+    EXPECT_EQ(expired_at, 40000000);
+};
+
+TEST(timing_wheel_test, test_many_timers_same_tick) {
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{64};
+    std::int64_t n_expired = 0;
+    for (std::int64_t i = 0; i < 1000; i++) {
+        wheel->schedule(i, 100 + i % 3);
+    }
+    wheel->advance(101, [&](std::int64_t) { n_expired++; });
+    EXPECT_EQ(n_expired, 667);
+    EXPECT_EQ(wheel->get_pending(), 333);
+};
+
+TEST(timing_wheel_test, test_expires_after_rotation_boundary) {
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{16};
+    std::int64_t expired_at = -1;
+    wheel->advance(63, [](std::int64_t) {});
+    wheel->schedule(1, 100);
+    wheel->advance(200, [&](std::int64_t) { expired_at = wheel->get_time(); });
+    EXPECT_EQ(expired_at, 100);
+};
+
+TEST(timing_wheel_test, test_far_future_timer_skips_idle_clock) {
+    // Only occupied slots and overflow re-sorts are visited, one per 64^4 ticks, not one step per 64 ticks.
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{16};
+    std::int64_t expired_at = -1;
+    std::int64_t expiry = (1LL << 32) + 12345;
+    wheel->schedule(1, expiry);
+    wheel->schedule(2, 777777);
+    auto start = std::chrono::steady_clock::now();
+    wheel->advance(1LL << 33, [&](std::int64_t id) { if (id == 1) expired_at = wheel->get_time(); });
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    EXPECT_EQ(expired_at, expiry);
+    EXPECT_EQ(wheel->get_pending(), 0);
+    EXPECT_LT(elapsed.count(), 50);
+};
+
+TEST(timing_wheel_test, test_expires_at_every_level_boundary) {
+    orderbook::timers::timing_wheel* wheel = new orderbook::timers::timing_wheel{64};
+    std::vector<std::int64_t> expected = {1, 63, 64, 65, 4095, 4096, 4097, 262144, 262145, 16777216, 16777217, 33554500};
+    for (std::int64_t i = 0; i < static_cast<std::int64_t>(expected.size()); i++) {
+        wheel->schedule(i, expected[i]);
+    }
+    std::vector<std::int64_t> times;
+    wheel->advance(1LL << 26, [&](std::int64_t) { times.push_back(wheel->get_time()); });
+    EXPECT_EQ(times, expected);
+};